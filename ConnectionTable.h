@@ -0,0 +1,394 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <poll.h>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Socket.h"
+#include "TCPSocket.h"
+
+namespace CPPSockets
+{
+
+// Stable reference to an entry in a ConnectionTable.
+// A handle stays valid until its connection is removed, after which the slot's generation is bumped so that
+// stale handles are rejected instead of silently aliasing whichever connection reuses the slot.
+struct ConnectionHandle
+{
+    std::uint32_t index {std::numeric_limits<std::uint32_t>::max()};
+    std::uint32_t generation {0};
+
+    auto          operator== (const ConnectionHandle& other) const -> bool = default;
+};
+
+// Slot map of connections with generational handles.
+// Connections are stored densely so iteration never skips holes, and removal swaps the last entry into the gap,
+// which keeps insert and remove O(1). Per connection state is split by access pattern:
+//  - hot:  file descriptor and cached status, scanned every loop iteration. Refreshed from the socket by forEach(),
+//          flushAll(), eraseClosed() and refresh(), which has to be called after closing a socket obtained through
+//          getSocket() or sockets() if none of the others runs before the next wait.
+//  - cold: the socket object itself, which carries the address and port strings.
+//  - user: caller supplied data of type UserData.
+template <typename UserData = std::monostate>
+class ConnectionTable
+{
+  public:
+    struct HotData
+    {
+        int                   fd;
+        Socket::ESocketStatus status;
+    };
+
+  private:
+    struct Slot
+    {
+        std::uint32_t denseIndex;
+        std::uint32_t generation;
+    };
+
+    static constexpr std::uint32_t NO_FREE_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<Slot>              m_slots;
+    std::uint32_t                  m_freeHead {NO_FREE_SLOT};
+
+    std::vector<HotData>           m_hot;
+    std::vector<TCPSocket>         m_sockets;
+    std::vector<UserData>          m_userData;
+    std::vector<std::uint32_t>     m_denseToSlot;
+
+    std::vector<pollfd>            m_pollFds;
+    TCPSocket::SpinStats           m_spinStats {};
+
+    // EXTRA_FD, if not -1, is polled behind the connections, at index m_hot.size().
+    auto pollAll(const int TIMEOUT_MS, const int EXTRA_FD) -> int
+    {
+        m_pollFds.resize(m_hot.size() + (EXTRA_FD == -1 ? 0 : 1));
+        for (std::size_t i = 0; i < m_hot.size(); ++i)
+        {
+            m_pollFds[i] = pollfd {.fd = m_hot[i].fd, .events = POLLIN, .revents = 0};
+        }
+        if (EXTRA_FD != -1)
+        {
+            m_pollFds.back() = pollfd {.fd = EXTRA_FD, .events = POLLIN, .revents = 0};
+        }
+        const int READY = ::poll(m_pollFds.data(), m_pollFds.size(), TIMEOUT_MS);
+        if (READY == -1 && errno != EINTR)
+        {
+            throw std::runtime_error("poll failed");
+        }
+        return READY;
+    }
+
+    [[nodiscard]]
+    auto findDense(const ConnectionHandle& handle) const noexcept -> std::size_t
+    {
+        if (handle.index >= m_slots.size())
+        {
+            return m_hot.size();
+        }
+        const Slot& SLOT = m_slots[handle.index];
+        if (SLOT.generation != handle.generation || SLOT.denseIndex >= m_hot.size())
+        {
+            return m_hot.size();
+        }
+        return SLOT.denseIndex;
+    }
+
+    void refreshDense(const std::size_t DENSE_INDEX) noexcept
+    {
+        m_hot[DENSE_INDEX].fd     = m_sockets[DENSE_INDEX].getFD();
+        m_hot[DENSE_INDEX].status = m_sockets[DENSE_INDEX].getStatus();
+    }
+
+    void removeDense(const std::size_t DENSE_INDEX)
+    {
+        const std::uint32_t SLOT_INDEX = m_denseToSlot[DENSE_INDEX];
+        const std::size_t   LAST       = m_hot.size() - 1;
+
+        if (DENSE_INDEX != LAST)
+        {
+            m_hot[DENSE_INDEX]         = m_hot[LAST];
+            // Swap rather than move-assign so that the removed socket is the one destroyed (and closed) below.
+            std::swap(m_sockets[DENSE_INDEX], m_sockets[LAST]);
+            m_userData[DENSE_INDEX]    = std::move(m_userData[LAST]);
+            m_denseToSlot[DENSE_INDEX] = m_denseToSlot[LAST];
+            m_slots[m_denseToSlot[DENSE_INDEX]].denseIndex = static_cast<std::uint32_t>(DENSE_INDEX);
+        }
+
+        m_hot.pop_back();
+        m_sockets.pop_back();
+        m_userData.pop_back();
+        m_denseToSlot.pop_back();
+
+        Slot& slot      = m_slots[SLOT_INDEX];
+        slot.generation++;
+        slot.denseIndex = m_freeHead;
+        m_freeHead      = SLOT_INDEX;
+    }
+
+  public:
+    ConnectionTable() = default;
+
+    explicit ConnectionTable(const std::size_t CAPACITY) { reserve(CAPACITY); }
+
+    void reserve(const std::size_t CAPACITY)
+    {
+        m_slots.reserve(CAPACITY);
+        m_hot.reserve(CAPACITY);
+        m_sockets.reserve(CAPACITY);
+        m_userData.reserve(CAPACITY);
+        m_denseToSlot.reserve(CAPACITY);
+    }
+
+    auto insert(TCPSocket&& socket, UserData userData = {}) -> ConnectionHandle
+    {
+        if (m_hot.size() >= NO_FREE_SLOT)
+        {
+            throw std::length_error("ConnectionTable is full");
+        }
+
+        std::uint32_t slotIndex {};
+        if (m_freeHead != NO_FREE_SLOT)
+        {
+            slotIndex  = m_freeHead;
+            m_freeHead = m_slots[slotIndex].denseIndex;
+        }
+        else
+        {
+            slotIndex = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back(Slot {.denseIndex = 0, .generation = 0});
+        }
+
+        const auto DENSE_INDEX        = static_cast<std::uint32_t>(m_hot.size());
+        m_slots[slotIndex].denseIndex = DENSE_INDEX;
+
+        m_hot.push_back(HotData {.fd = socket.getFD(), .status = socket.getStatus()});
+        m_sockets.push_back(std::move(socket));
+        m_userData.push_back(std::move(userData));
+        m_denseToSlot.push_back(slotIndex);
+
+        return ConnectionHandle {.index = slotIndex, .generation = m_slots[slotIndex].generation};
+    }
+
+    auto remove(const ConnectionHandle& handle) -> bool
+    {
+        const std::size_t DENSE_INDEX = findDense(handle);
+        if (DENSE_INDEX == m_hot.size())
+        {
+            return false;
+        }
+        removeDense(DENSE_INDEX);
+        return true;
+    }
+
+    // Updates the cached hot data of one connection from its socket. Returns false for a stale handle.
+    auto refresh(const ConnectionHandle& handle) noexcept -> bool
+    {
+        const std::size_t DENSE_INDEX = findDense(handle);
+        if (DENSE_INDEX == m_hot.size())
+        {
+            return false;
+        }
+        refreshDense(DENSE_INDEX);
+        return true;
+    }
+
+    [[nodiscard]]
+    auto contains(const ConnectionHandle& handle) const noexcept -> bool
+    {
+        return findDense(handle) != m_hot.size();
+    }
+
+    [[nodiscard]]
+    auto getSocket(const ConnectionHandle& handle) noexcept -> TCPSocket*
+    {
+        const std::size_t DENSE_INDEX = findDense(handle);
+        return DENSE_INDEX == m_hot.size() ? nullptr : &m_sockets[DENSE_INDEX];
+    }
+
+    [[nodiscard]]
+    auto getUserData(const ConnectionHandle& handle) noexcept -> UserData*
+    {
+        const std::size_t DENSE_INDEX = findDense(handle);
+        return DENSE_INDEX == m_hot.size() ? nullptr : &m_userData[DENSE_INDEX];
+    }
+
+    [[nodiscard]]
+    auto getHandle(const std::size_t DENSE_INDEX) const -> ConnectionHandle
+    {
+        const std::uint32_t SLOT_INDEX = m_denseToSlot.at(DENSE_INDEX);
+        return ConnectionHandle {.index = SLOT_INDEX, .generation = m_slots[SLOT_INDEX].generation};
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t
+    {
+        return m_hot.size();
+    }
+
+    [[nodiscard]]
+    auto empty() const noexcept -> bool
+    {
+        return m_hot.empty();
+    }
+
+    // Dense views, indexed by position. Positions change on removal, use handles to refer to a connection.
+    [[nodiscard]]
+    auto hot() const noexcept -> std::span<const HotData>
+    {
+        return m_hot;
+    }
+
+    [[nodiscard]]
+    auto sockets() noexcept -> std::span<TCPSocket>
+    {
+        return m_sockets;
+    }
+
+    [[nodiscard]]
+    auto userData() noexcept -> std::span<UserData>
+    {
+        return m_userData;
+    }
+
+    // Calls func(handle, socket, userData) for every connection and refreshes the cached hot data afterwards.
+    template <typename Func>
+    void forEach(Func&& func)
+    {
+        for (std::size_t i = 0; i < m_hot.size(); ++i)
+        {
+            func(getHandle(i), m_sockets[i], m_userData[i]);
+            refreshDense(i);
+        }
+    }
+
+    // Removes every connection for which pred(socket, userData) returns true. Returns the number removed.
+    template <typename Predicate>
+    auto eraseIf(Predicate&& pred) -> std::size_t
+    {
+        std::size_t removed {};
+        // Walk backwards so that the entry swapped into a freed position has already been visited.
+        for (std::size_t i = m_hot.size(); i-- > 0;)
+        {
+            if (pred(m_sockets[i], m_userData[i]))
+            {
+                removeDense(i);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes connections that are no longer open, including those closed through getSocket() or sockets().
+    auto eraseClosed() -> std::size_t
+    {
+        std::size_t removed {};
+        for (std::size_t i = m_hot.size(); i-- > 0;)
+        {
+            refreshDense(i);
+            if (!Socket::isOpenStatus(m_hot[i].status))
+            {
+                removeDense(i);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Flushes coalesced writes of every connection, meant to be called once at the end of each loop iteration.
+    void flushAll() noexcept
+    {
+        for (std::size_t i = 0; i < m_hot.size(); ++i)
+        {
+            m_sockets[i].flush();
+            refreshDense(i);
+        }
+    }
+
+  private:
+    auto collectReadable(std::vector<ConnectionHandle>& ready, const TCPSocket::SpinConfig& config, const int EXTRA_FD)
+      -> std::size_t
+    {
+        ready.clear();
+        if (m_hot.empty() && EXTRA_FD == -1 && config.blockTimeout.count() < 0)
+        {
+            // Nothing could ever become readable, poll() would block forever.
+            return 0;
+        }
+
+        const auto DEADLINE = std::chrono::steady_clock::now() + config.spinBudget;
+        int        readyCount {};
+        do
+        {
+            readyCount = pollAll(0, EXTRA_FD);
+        } while (readyCount <= 0 && std::chrono::steady_clock::now() < DEADLINE);
+
+        if (readyCount > 0)
+        {
+            m_spinStats.hits++;
+        }
+        else
+        {
+            m_spinStats.misses++;
+            readyCount = pollAll(static_cast<int>(config.blockTimeout.count()), EXTRA_FD);
+        }
+
+        for (std::size_t i = 0; readyCount > 0 && i < m_hot.size(); ++i)
+        {
+            if (m_pollFds[i].revents != 0)
+            {
+                ready.push_back(getHandle(i));
+            }
+        }
+        return ready.size();
+    }
+
+  public:
+    // Collects the handles of connections that are readable (or closed) into ready and returns their count.
+    // Spins with zero timeout polls for config.spinBudget before blocking for up to config.blockTimeout, see
+    // TCPSocket::recvSpin(). Returns 0 right away if the table is empty and the timeout infinite.
+    auto waitReadable(std::vector<ConnectionHandle>& ready, const TCPSocket::SpinConfig& config) -> std::size_t
+    {
+        return collectReadable(ready, config, -1);
+    }
+
+    // Same, but also wakes up for new connections on listener, which can not be part of the table.
+    // listenerReadable tells whether accept() will find a connection.
+    auto waitReadable(
+      std::vector<ConnectionHandle>& ready,
+      const TCPSocket::SpinConfig&   config,
+      const Socket&                  listener,
+      bool&                          listenerReadable
+    ) -> std::size_t
+    {
+        const std::size_t COUNT = collectReadable(ready, config, listener.getFD());
+        listenerReadable        = m_pollFds.size() > m_hot.size() && m_pollFds.back().revents != 0;
+        return COUNT;
+    }
+
+    [[nodiscard]]
+    auto getSpinStats() const noexcept -> TCPSocket::SpinStats
+    {
+        return m_spinStats;
+    }
+
+    void resetSpinStats() noexcept { m_spinStats = TCPSocket::SpinStats {}; }
+
+    void clear()
+    {
+        for (std::size_t i = m_hot.size(); i-- > 0;)
+        {
+            removeDense(i);
+        }
+    }
+};
+
+} // namespace CPPSockets
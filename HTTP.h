@@ -0,0 +1,735 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "TCPSocket.h"
+#include "Transport.h"
+
+namespace CPPSockets
+{
+
+namespace HTTPDetail
+{
+
+inline auto toLower(const char CHAR) noexcept -> char
+{
+    return (CHAR >= 'A' && CHAR <= 'Z') ? static_cast<char>(CHAR + ('a' - 'A')) : CHAR;
+}
+
+inline auto equalsIgnoreCase(const std::string_view LHS, const std::string_view RHS) noexcept -> bool
+{
+    return std::ranges::equal(
+      LHS, RHS, [](const char LEFT, const char RIGHT) { return toLower(LEFT) == toLower(RIGHT); }
+    );
+}
+
+inline auto trim(std::string_view view) noexcept -> std::string_view
+{
+    while (!view.empty() && (view.front() == ' ' || view.front() == '\t'))
+    {
+        view.remove_prefix(1);
+    }
+    while (!view.empty() && (view.back() == ' ' || view.back() == '\t'))
+    {
+        view.remove_suffix(1);
+    }
+    return view;
+}
+
+// Whether the comma separated header value contains TOKEN, e.g. "keep-alive" in "Keep-Alive, Upgrade".
+inline auto containsToken(std::string_view value, const std::string_view TOKEN) noexcept -> bool
+{
+    while (!value.empty())
+    {
+        const auto COMMA = value.find(',');
+        if (equalsIgnoreCase(trim(value.substr(0, COMMA)), TOKEN))
+        {
+            return true;
+        }
+        if (COMMA == std::string_view::npos)
+        {
+            break;
+        }
+        value.remove_prefix(COMMA + 1);
+    }
+    return false;
+}
+
+} // namespace HTTPDetail
+
+struct HTTPHeader
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+// A parsed request. All views point into the receive buffer of the HTTPSession that produced it and are only
+// valid while its handler runs.
+class HTTPRequest
+{
+  private:
+    std::string_view        m_method;
+    std::string_view        m_target;
+    int                     m_minorVersion {1};
+    // Cleared but never shrunk, so parsing reuses the capacity from earlier requests.
+    std::vector<HTTPHeader> m_headers;
+    std::string_view        m_body;
+
+    friend class HTTPRequestParser;
+
+  public:
+    [[nodiscard]]
+    auto getMethod() const noexcept -> std::string_view
+    {
+        return m_method;
+    }
+
+    [[nodiscard]]
+    auto getTarget() const noexcept -> std::string_view
+    {
+        return m_target;
+    }
+
+    // 0 for HTTP/1.0, 1 for HTTP/1.1.
+    [[nodiscard]]
+    auto getMinorVersion() const noexcept -> int
+    {
+        return m_minorVersion;
+    }
+
+    [[nodiscard]]
+    auto getHeaders() const noexcept -> std::span<const HTTPHeader>
+    {
+        return m_headers;
+    }
+
+    // Case insensitive lookup of the first header called NAME.
+    [[nodiscard]]
+    auto getHeader(const std::string_view NAME) const noexcept -> std::optional<std::string_view>
+    {
+        for (const auto& header : m_headers)
+        {
+            if (HTTPDetail::equalsIgnoreCase(header.name, NAME))
+            {
+                return header.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]]
+    auto getBody() const noexcept -> std::string_view
+    {
+        return m_body;
+    }
+
+    [[nodiscard]]
+    auto isKeepAlive() const noexcept -> bool
+    {
+        const auto CONNECTION = getHeader("Connection");
+        if (m_minorVersion == 0)
+        {
+            return CONNECTION.has_value() && HTTPDetail::containsToken(*CONNECTION, "keep-alive");
+        }
+        return !CONNECTION.has_value() || !HTTPDetail::containsToken(*CONNECTION, "close");
+    }
+};
+
+// Incremental HTTP/1.x request parser.
+// parse() is called with everything received so far for the current request and remembers how far it got, so
+// neither the header search nor chunk decoding starts over when more data arrives. Chunked bodies are decoded in
+// place, which is why the buffer is mutable: the body ends up contiguous right behind the header block.
+class HTTPRequestParser
+{
+  public:
+    enum class EResult : std::uint8_t
+    {
+        COMPLETE,
+        INCOMPLETE,
+        ERROR,
+        // The body is larger than the configured maximum, to be answered with 413.
+        TOO_LARGE,
+        // A transfer coding other than a sole "chunked", to be answered with 501.
+        NOT_IMPLEMENTED,
+    };
+
+    static constexpr std::size_t DEFAULT_MAX_HEADERS {64};
+    static constexpr std::size_t UNLIMITED_BODY_SIZE {~std::size_t {0}};
+
+  private:
+    enum class EBodyMode : std::uint8_t
+    {
+        NONE,
+        CONTENT_LENGTH,
+        CHUNKED,
+    };
+
+    std::size_t m_maxHeaders;
+    std::size_t m_maxBodySize;
+
+    // Offset up to which the header block was searched for its terminating empty line.
+    std::size_t m_headerScanOffset {0};
+    // Length of the header block including the empty line, 0 while not yet known.
+    std::size_t m_headerLength {0};
+    EBodyMode   m_bodyMode {EBodyMode::NONE};
+    std::size_t m_contentLength {0};
+    // Chunked decoding: next undecoded byte and end of the decoded body.
+    std::size_t m_chunkReadOffset {0};
+    std::size_t m_chunkWriteOffset {0};
+    bool        m_inTrailers {false};
+
+    // Returns COMPLETE if the header block is valid, otherwise ERROR or NOT_IMPLEMENTED.
+    auto parseHeaderBlock(const std::string_view BLOCK, HTTPRequest& request) -> EResult
+    {
+        request.m_headers.clear();
+
+        auto lineEnd = BLOCK.find("\r\n");
+        auto line    = BLOCK.substr(0, lineEnd);
+
+        const auto FIRST_SPACE  = line.find(' ');
+        const auto SECOND_SPACE = line.find(' ', FIRST_SPACE + 1);
+        if (FIRST_SPACE == 0 || FIRST_SPACE == std::string_view::npos || SECOND_SPACE == std::string_view::npos
+            || SECOND_SPACE == FIRST_SPACE + 1)
+        {
+            return EResult::ERROR;
+        }
+        const auto VERSION = line.substr(SECOND_SPACE + 1);
+        if (VERSION == "HTTP/1.1")
+        {
+            request.m_minorVersion = 1;
+        }
+        else if (VERSION == "HTTP/1.0")
+        {
+            request.m_minorVersion = 0;
+        }
+        else
+        {
+            return EResult::ERROR;
+        }
+        request.m_method = line.substr(0, FIRST_SPACE);
+        request.m_target = line.substr(FIRST_SPACE + 1, SECOND_SPACE - FIRST_SPACE - 1);
+
+        m_bodyMode      = EBodyMode::NONE;
+        m_contentLength = 0;
+        bool hasContentLength {false};
+
+        std::size_t offset = lineEnd + 2;
+        while (offset < BLOCK.size())
+        {
+            lineEnd = BLOCK.find("\r\n", offset);
+            line    = BLOCK.substr(offset, lineEnd - offset);
+            offset  = lineEnd + 2;
+            if (line.empty())
+            {
+                break;
+            }
+
+            const auto COLON = line.find(':');
+            // Obsolete line folding (leading whitespace) is rejected, as RFC 9112 allows, and so is whitespace
+            // between the field name and the colon, which RFC 9112 requires.
+            if (COLON == 0 || COLON == std::string_view::npos
+                || line.substr(0, COLON).find_first_of(" \t") != std::string_view::npos)
+            {
+                return EResult::ERROR;
+            }
+            if (request.m_headers.size() == m_maxHeaders)
+            {
+                return EResult::ERROR;
+            }
+
+            const HTTPHeader HEADER {.name = line.substr(0, COLON), .value = HTTPDetail::trim(line.substr(COLON + 1))};
+            request.m_headers.push_back(HEADER);
+
+            if (HTTPDetail::equalsIgnoreCase(HEADER.name, "Transfer-Encoding"))
+            {
+                // Other codings would have to be decoded, a repeated header would stack another coding on top.
+                if (m_bodyMode == EBodyMode::CHUNKED || !HTTPDetail::equalsIgnoreCase(HEADER.value, "chunked"))
+                {
+                    return EResult::NOT_IMPLEMENTED;
+                }
+                m_bodyMode = EBodyMode::CHUNKED;
+            }
+            else if (HTTPDetail::equalsIgnoreCase(HEADER.name, "Content-Length"))
+            {
+                std::size_t length {};
+                const auto* end    = HEADER.value.data() + HEADER.value.size();
+                const auto  RESULT = std::from_chars(HEADER.value.data(), end, length);
+                if (RESULT.ec != std::errc {} || RESULT.ptr != end
+                    || (hasContentLength && length != m_contentLength))
+                {
+                    return EResult::ERROR;
+                }
+                hasContentLength = true;
+                m_contentLength  = length;
+            }
+        }
+        if (hasContentLength)
+        {
+            // Both framings in one request is how requests are smuggled past proxies that pick the other one.
+            if (m_bodyMode == EBodyMode::CHUNKED)
+            {
+                return EResult::ERROR;
+            }
+            m_bodyMode = EBodyMode::CONTENT_LENGTH;
+        }
+        return EResult::COMPLETE;
+    }
+
+    auto decodeChunks(const std::span<char> buffer) -> EResult
+    {
+        char* const DATA = buffer.data();
+        while (true)
+        {
+            const std::string_view REST {DATA + m_chunkReadOffset, buffer.size() - m_chunkReadOffset};
+            const auto             LINE_END = REST.find("\r\n");
+            if (LINE_END == std::string_view::npos)
+            {
+                return EResult::INCOMPLETE;
+            }
+
+            if (m_inTrailers)
+            {
+                m_chunkReadOffset += LINE_END + 2;
+                if (LINE_END == 0)
+                {
+                    return EResult::COMPLETE;
+                }
+                continue;
+            }
+
+            std::size_t chunkSize {};
+            const auto  RESULT = std::from_chars(REST.data(), REST.data() + LINE_END, chunkSize, 16);
+            if (RESULT.ec != std::errc {} || (RESULT.ptr != REST.data() + LINE_END && *RESULT.ptr != ';'))
+            {
+                return EResult::ERROR;
+            }
+
+            if (chunkSize == 0)
+            {
+                m_chunkReadOffset += LINE_END + 2;
+                m_inTrailers       = true;
+                continue;
+            }
+
+            // The size comes from the client, nothing may be added to it before it is known to be in range.
+            if (chunkSize > m_maxBodySize - (m_chunkWriteOffset - m_headerLength))
+            {
+                return EResult::TOO_LARGE;
+            }
+            const std::size_t AVAILABLE = REST.size() - LINE_END - 2;
+            if (chunkSize > AVAILABLE || AVAILABLE - chunkSize < 2)
+            {
+                return EResult::INCOMPLETE;
+            }
+            if (REST.substr(LINE_END + 2 + chunkSize, 2) != "\r\n")
+            {
+                return EResult::ERROR;
+            }
+
+            std::memmove(DATA + m_chunkWriteOffset, REST.data() + LINE_END + 2, chunkSize);
+            m_chunkWriteOffset += chunkSize;
+            m_chunkReadOffset  += LINE_END + 2 + chunkSize + 2;
+        }
+    }
+
+  public:
+    explicit HTTPRequestParser(
+      const std::size_t MAX_HEADERS   = DEFAULT_MAX_HEADERS,
+      const std::size_t MAX_BODY_SIZE = UNLIMITED_BODY_SIZE
+    )
+      : m_maxHeaders {MAX_HEADERS}, m_maxBodySize {MAX_BODY_SIZE}
+    {}
+
+    [[nodiscard]]
+    auto isHeaderComplete() const noexcept -> bool
+    {
+        return m_headerLength != 0;
+    }
+
+    // Forget all progress, to be called after a request was completed or when the buffer was moved.
+    void reset() noexcept
+    {
+        m_headerScanOffset = 0;
+        m_headerLength     = 0;
+        m_bodyMode         = EBodyMode::NONE;
+        m_contentLength    = 0;
+        m_chunkReadOffset  = 0;
+        m_chunkWriteOffset = 0;
+        m_inTrailers       = false;
+    }
+
+    // Parses the request at the start of buffer. On COMPLETE, consumed is set to the length of the request on the
+    // wire, anything after that belongs to the next pipelined request.
+    auto parse(const std::span<char> buffer, HTTPRequest& request, std::size_t& consumed) -> EResult
+    {
+        const std::string_view VIEW {buffer.data(), buffer.size()};
+
+        if (m_headerLength == 0)
+        {
+            // Step back a few bytes in case the terminator straddles the previous end of data.
+            static constexpr std::size_t TERMINATOR_LENGTH {4};
+            const std::size_t            SEARCH_FROM = m_headerScanOffset >= TERMINATOR_LENGTH - 1
+                                                         ? m_headerScanOffset - (TERMINATOR_LENGTH - 1)
+                                                         : 0;
+            const auto                   HEADER_END  = VIEW.find("\r\n\r\n", SEARCH_FROM);
+            if (HEADER_END == std::string_view::npos)
+            {
+                m_headerScanOffset = VIEW.size();
+                return EResult::INCOMPLETE;
+            }
+            m_headerLength     = HEADER_END + TERMINATOR_LENGTH;
+            m_chunkReadOffset  = m_headerLength;
+            m_chunkWriteOffset = m_headerLength;
+        }
+
+        // Cheap compared to receiving, and re-parsing keeps the views valid even if the buffer moved in between.
+        if (const EResult HEADER_RESULT = parseHeaderBlock(VIEW.substr(0, m_headerLength), request);
+            HEADER_RESULT != EResult::COMPLETE)
+        {
+            return HEADER_RESULT;
+        }
+
+        switch (m_bodyMode)
+        {
+            case EBodyMode::NONE:
+                request.m_body = {};
+                consumed       = m_headerLength;
+                return EResult::COMPLETE;
+            case EBodyMode::CONTENT_LENGTH:
+                if (m_contentLength > m_maxBodySize)
+                {
+                    return EResult::TOO_LARGE;
+                }
+                if (VIEW.size() - m_headerLength < m_contentLength)
+                {
+                    return EResult::INCOMPLETE;
+                }
+                request.m_body = VIEW.substr(m_headerLength, m_contentLength);
+                consumed       = m_headerLength + m_contentLength;
+                return EResult::COMPLETE;
+            case EBodyMode::CHUNKED:
+            {
+                const EResult RESULT = decodeChunks(buffer);
+                if (RESULT == EResult::COMPLETE)
+                {
+                    request.m_body = VIEW.substr(m_headerLength, m_chunkWriteOffset - m_headerLength);
+                    consumed       = m_chunkReadOffset;
+                }
+                return RESULT;
+            }
+        }
+        return EResult::ERROR;
+    }
+};
+
+// Response to an HTTPRequest. The status line and headers are serialized into a reused buffer and go out in one
+// gathered write together with the body, which is never copied.
+class HTTPResponse
+{
+  private:
+    int              m_status {200};
+    std::string      m_headers;
+    std::string_view m_body;
+    std::string      m_ownedBody;
+    bool             m_keepAlive {true};
+    int              m_requestMinorVersion {1};
+
+  public:
+    [[nodiscard]]
+    static auto getReasonPhrase(const int STATUS) noexcept -> std::string_view
+    {
+        switch (STATUS)
+        {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 301: return "Moved Permanently";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 413: return "Content Too Large";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            default: return "Unknown";
+        }
+    }
+
+    void reset()
+    {
+        m_status = 200;
+        m_headers.clear();
+        m_body = {};
+        m_ownedBody.clear();
+        m_keepAlive           = true;
+        m_requestMinorVersion = 1;
+    }
+
+    // 204, 304 and informational responses never have a body, nor a Content-Length.
+    [[nodiscard]]
+    static auto hasBody(const int STATUS) noexcept -> bool
+    {
+        return STATUS >= 200 && STATUS != 204 && STATUS != 304;
+    }
+
+    void setStatus(const int STATUS) noexcept { m_status = STATUS; }
+
+    [[nodiscard]]
+    auto getStatus() const noexcept -> int
+    {
+        return m_status;
+    }
+
+    // Content-Length and Connection are added when the response is sent.
+    void addHeader(const std::string_view NAME, const std::string_view VALUE)
+    {
+        m_headers.append(NAME).append(": ").append(VALUE).append("\r\n");
+    }
+
+    // The viewed data must stay alive until the response was sent.
+    void setBody(const std::string_view BODY) noexcept { m_body = BODY; }
+
+    void setBody(std::string&& body)
+    {
+        m_ownedBody = std::move(body);
+        m_body      = m_ownedBody;
+    }
+
+    [[nodiscard]]
+    auto getBody() const noexcept -> std::string_view
+    {
+        return m_body;
+    }
+
+    // Closes the connection after this response.
+    void setKeepAlive(const bool KEEP_ALIVE) noexcept { m_keepAlive = KEEP_ALIVE; }
+
+    // HTTP/1.0 clients close after every response unless it carries Connection: keep-alive.
+    void setRequestMinorVersion(const int MINOR_VERSION) noexcept { m_requestMinorVersion = MINOR_VERSION; }
+
+    [[nodiscard]]
+    auto isKeepAlive() const noexcept -> bool
+    {
+        return m_keepAlive;
+    }
+
+    // The body to send, empty for statuses that must not have one.
+    [[nodiscard]]
+    auto getWireBody() const noexcept -> std::string_view
+    {
+        return hasBody(m_status) ? m_body : std::string_view {};
+    }
+
+    // Serializes status line and headers into head, the body is sent separately.
+    void serializeHead(std::string& head) const
+    {
+        static constexpr std::size_t NUMBER_BUFFER_SIZE {24};
+        std::array<char, NUMBER_BUFFER_SIZE> number {};
+
+        head.clear();
+        head.append("HTTP/1.1 ");
+        auto result = std::to_chars(number.data(), number.data() + number.size(), m_status);
+        head.append(number.data(), result.ptr);
+        head.append(" ").append(getReasonPhrase(m_status)).append("\r\n");
+        head.append(m_headers);
+        if (hasBody(m_status))
+        {
+            head.append("Content-Length: ");
+            result = std::to_chars(number.data(), number.data() + number.size(), m_body.size());
+            head.append(number.data(), result.ptr);
+            head.append("\r\n");
+        }
+        if (!m_keepAlive)
+        {
+            head.append("Connection: close\r\n");
+        }
+        else if (m_requestMinorVersion == 0)
+        {
+            head.append("Connection: keep-alive\r\n");
+        }
+        head.append("\r\n");
+    }
+};
+
+// Per connection HTTP state, meant to be used as the user data of a ConnectionTable or next to a TCPSocket.
+// process() reads from the socket straight into a fixed size buffer, parses every complete (possibly pipelined)
+// request in it, calls the handler and writes the responses. The session turns on write coalescing on the socket
+// so that all responses produced by one process() call leave in a single gathered write. Requests larger than the
+// buffer are answered with 431 or 413, unsupported transfer codings with 501, and the connection is closed.
+class HTTPSession
+{
+  public:
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE {static_cast<std::size_t>(64 * 1'024)};
+
+  private:
+    std::vector<char>  m_buffer;
+    std::size_t        m_bufferSize;
+    // Start of the request currently being parsed and end of the received data.
+    std::size_t        m_begin {0};
+    std::size_t        m_end {0};
+
+    HTTPRequestParser  m_parser;
+    HTTPRequest        m_request;
+    HTTPResponse       m_response;
+    std::string        m_head;
+
+    std::uint64_t      m_requestCount {0};
+
+    template <StreamConnection Connection>
+    auto sendResponse(Connection& socket) -> bool
+    {
+        m_response.serializeHead(m_head);
+        const std::array<std::string_view, 2> PARTS {m_head, m_response.getWireBody()};
+        if (socket.sendGathered(PARTS) == -1)
+        {
+            return false;
+        }
+        if (!m_response.isKeepAlive())
+        {
+            socket.flush();
+            socket.close();
+            return false;
+        }
+        return true;
+    }
+
+    template <StreamConnection Connection>
+    auto sendError(Connection& socket, const int STATUS) -> bool
+    {
+        m_response.reset();
+        m_response.setStatus(STATUS);
+        m_response.setKeepAlive(false);
+        return sendResponse(socket);
+    }
+
+  public:
+    HTTPSession() : HTTPSession(DEFAULT_BUFFER_SIZE) {}
+    // No body can be larger than the buffer it has to fit into.
+    explicit HTTPSession(const std::size_t BUFFER_SIZE)
+      : m_bufferSize {BUFFER_SIZE}, m_parser {HTTPRequestParser::DEFAULT_MAX_HEADERS, BUFFER_SIZE}
+    {}
+
+    // Handler is called as handler(const HTTPRequest&, HTTPResponse&) once per request, in order.
+    // Returns false once the connection is closed or failed. Works on any StreamConnection, a TCPSocket or a
+    // SimulatedConnection.
+    template <StreamConnection Connection, typename Handler>
+    auto process(Connection& socket, Handler&& handler) -> bool
+    {
+        if (m_buffer.empty())
+        {
+            m_buffer.resize(m_bufferSize);
+            // Responses to pipelined requests go out together at the end of process(). Small ones are copied
+            // into the coalescing buffer, large ones still go out directly from the response body.
+            if constexpr (requires { socket.enableCoalescing(); })
+            {
+                if (!socket.isCoalescing())
+                {
+                    socket.enableCoalescing();
+                }
+            }
+        }
+
+        // Data from a previous partial write has to leave before more responses are queued behind it.
+        if (socket.getPendingBytes() > 0 && socket.flush() == -1)
+        {
+            return false;
+        }
+
+        const bool BLOCKING = socket.isBlocking();
+        while (socket.isOpen())
+        {
+            if (m_end == m_buffer.size())
+            {
+                if (m_begin == 0)
+                {
+                    return sendError(socket, m_parser.isHeaderComplete() ? 413 : 431);
+                }
+                // Move the partial request to the front. The parser works with offsets, so its progress survives.
+                std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+                m_end   -= m_begin;
+                m_begin  = 0;
+            }
+
+            const std::int64_t BYTES_READ = socket.recvInto(std::span<char> {m_buffer}.subspan(m_end));
+            if (BYTES_READ <= 0)
+            {
+                break;
+            }
+            m_end += static_cast<std::size_t>(BYTES_READ);
+
+            while (m_begin < m_end)
+            {
+                std::size_t                      consumed {};
+                const HTTPRequestParser::EResult RESULT = m_parser.parse(
+                  std::span<char> {m_buffer}.subspan(m_begin, m_end - m_begin), m_request, consumed
+                );
+                if (RESULT == HTTPRequestParser::EResult::INCOMPLETE)
+                {
+                    break;
+                }
+                if (RESULT == HTTPRequestParser::EResult::ERROR)
+                {
+                    return sendError(socket, 400);
+                }
+                if (RESULT == HTTPRequestParser::EResult::TOO_LARGE)
+                {
+                    return sendError(socket, 413);
+                }
+                if (RESULT == HTTPRequestParser::EResult::NOT_IMPLEMENTED)
+                {
+                    return sendError(socket, 501);
+                }
+
+                m_response.reset();
+                m_response.setKeepAlive(m_request.isKeepAlive());
+                m_response.setRequestMinorVersion(m_request.getMinorVersion());
+                handler(std::as_const(m_request), m_response);
+                m_requestCount++;
+
+                m_begin += consumed;
+                m_parser.reset();
+                if (!sendResponse(socket))
+                {
+                    return false;
+                }
+            }
+
+            if (m_begin == m_end)
+            {
+                m_begin = 0;
+                m_end   = 0;
+            }
+
+            if (BLOCKING)
+            {
+                // One read per call on blocking sockets, the next one would wait for the client.
+                break;
+            }
+        }
+        socket.flush();
+        return socket.isOpen();
+    }
+
+    [[nodiscard]]
+    auto getRequestCount() const noexcept -> std::uint64_t
+    {
+        return m_requestCount;
+    }
+};
+
+} // namespace CPPSockets
@@ -0,0 +1,703 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/eventfd.h>
+#include <unordered_map>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "TCPSocket.h"
+
+namespace CPPSockets
+{
+
+// Many concurrent request streams over one TCPSocket.
+// Every frame carries a stream id, outgoing frames of all streams are interleaved round robin and each stream has
+// its own send window that the peer replenishes with WINDOW_UPDATE frames as it consumes data, so one bulky stream
+// can neither starve the others nor overrun the receiver. The client opens odd stream ids, the server even ones.
+//
+// Frame layout, all fields in network byte order:
+//   stream id (4) | payload length (4) | type (1) | flags (1) | reserved (2) | payload
+//
+// pump() performs the I/O and must be driven by one thread. call(), send(), openStream() and reset() may be used
+// from any thread, handlers run on the pumping thread.
+class MultiplexedConnection
+{
+  public:
+    using StreamID = std::uint32_t;
+    // Called with every chunk received on a stream, END_STREAM is reported with the last one.
+    using StreamHandler  = std::function<void(StreamID, std::string_view data, bool endStream)>;
+    // Called once with the complete request of a peer initiated stream. Answer with send(id, response, true).
+    using RequestHandler = std::function<void(StreamID, std::string&& request)>;
+
+    enum class ERole : std::uint8_t
+    {
+        CLIENT,
+        SERVER,
+    };
+
+    struct Config
+    {
+        std::uint32_t maxFrameSize {static_cast<std::uint32_t>(16 * 1'024)};
+        // Unacknowledged bytes one stream may have in flight. Requests for setRequestHandler() are buffered without
+        // returning window, so this is also the largest request accepted there, larger ones are reset.
+        std::uint32_t initialWindow {static_cast<std::uint32_t>(256 * 1'024)};
+        // Peer initiated streams open at the same time, further ones are reset.
+        std::size_t   maxConcurrentStreams {static_cast<std::size_t>(100)};
+        // Stop producing frames once this much is waiting in the socket's send buffer.
+        std::size_t   sendHighWatermark {static_cast<std::size_t>(256 * 1'024)};
+    };
+
+    // Head of line blocking metrics.
+    // Queue delay is measured per message, from send() until its last byte was handed to the socket, and grows when
+    // a message has to wait for other streams, its own flow control window or a full socket.
+    struct Metrics
+    {
+        std::uint64_t             framesSent {0};
+        std::uint64_t             framesReceived {0};
+        std::uint64_t             messagesSent {0};
+        std::chrono::microseconds totalQueueDelay {0};
+        std::chrono::microseconds maxQueueDelay {0};
+        // Times a stream had data to send but no window left.
+        std::uint64_t             flowControlStalls {0};
+        // Times sending stopped because the socket was backed up while streams still had data.
+        std::uint64_t             socketStalls {0};
+        // Peer streams reset for exceeding maxConcurrentStreams or the request size.
+        std::uint64_t             refusedStreams {0};
+        std::size_t               openStreams {0};
+    };
+
+  private:
+    enum class EFrameType : std::uint8_t
+    {
+        DATA,
+        WINDOW_UPDATE,
+        RESET,
+    };
+
+    static constexpr std::uint8_t FLAG_END_STREAM {0x1};
+    static constexpr std::size_t  HEADER_SIZE {12};
+
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingMessage
+    {
+        // Offset in sendBuffer right behind the message.
+        std::size_t       end;
+        Clock::time_point queuedAt;
+    };
+
+    struct Stream
+    {
+        StreamHandler              handler;
+        std::string                sendBuffer;
+        std::size_t                sendOffset {0};
+        std::deque<PendingMessage> pendingMessages;
+        std::int64_t               sendWindow {0};
+        std::int64_t               receiveWindow {0};
+        // Consumed bytes not yet returned to the peer with a WINDOW_UPDATE.
+        std::uint32_t              unacknowledged {0};
+        std::string                request;
+        bool                       endQueued {false};
+        bool                       endSent {false};
+        bool                       remoteEnded {false};
+        bool                       scheduled {false};
+    };
+
+    struct FrameHeader
+    {
+        StreamID      streamID;
+        std::uint32_t length;
+        EFrameType    type;
+        std::uint8_t  flags;
+    };
+
+    TCPSocket                                         m_socket;
+    ERole                                             m_role;
+    Config                                            m_config;
+
+    // Guards everything below, the socket and the receive buffer belong to the pumping thread.
+    mutable std::mutex                                m_mutex;
+    std::unordered_map<StreamID, std::shared_ptr<Stream>> m_streams;
+    std::deque<StreamID>                              m_sendOrder;
+    std::vector<std::pair<StreamID, std::uint32_t>>   m_windowUpdates;
+    std::vector<StreamID>                             m_resets;
+    StreamID                                          m_nextStreamID;
+    StreamID                                          m_lastPeerStreamID {0};
+    StreamHandler                                     m_streamHandler;
+    RequestHandler                                    m_requestHandler;
+    Metrics                                           m_metrics {};
+    // Set while pump() waits in poll(), so that send() knows it has to wake it up through m_wakeFD.
+    bool                                              m_waiting {false};
+    // Set once the connection is gone, streams opened afterwards fail right away.
+    bool                                              m_closed {false};
+    int                                               m_wakeFD;
+
+    std::vector<char>                                 m_receiveBuffer;
+    std::size_t                                       m_receiveBegin {0};
+    std::size_t                                       m_receiveEnd {0};
+
+    static void encodeHeader(std::array<char, HEADER_SIZE>& out, const FrameHeader& header) noexcept
+    {
+        const std::uint32_t STREAM_ID = htonl(header.streamID);
+        const std::uint32_t LENGTH    = htonl(header.length);
+        std::memcpy(out.data(), &STREAM_ID, sizeof(STREAM_ID));
+        std::memcpy(out.data() + 4, &LENGTH, sizeof(LENGTH));
+        out[8]  = static_cast<char>(header.type);
+        out[9]  = static_cast<char>(header.flags);
+        out[10] = 0;
+        out[11] = 0;
+    }
+
+    static auto decodeHeader(const char* data) noexcept -> FrameHeader
+    {
+        std::uint32_t streamID {};
+        std::uint32_t length {};
+        std::memcpy(&streamID, data, sizeof(streamID));
+        std::memcpy(&length, data + 4, sizeof(length));
+        return FrameHeader {
+          .streamID = ntohl(streamID),
+          .length   = ntohl(length),
+          .type     = static_cast<EFrameType>(data[8]),
+          .flags    = static_cast<std::uint8_t>(data[9]),
+        };
+    }
+
+    [[nodiscard]]
+    auto isPeerStream(const StreamID ID) const noexcept -> bool
+    {
+        // Client streams are odd, server streams even.
+        return (ID % 2 == 1) == (m_role == ERole::SERVER);
+    }
+
+    // Expects m_mutex to be held.
+    void wakePump() const noexcept
+    {
+        if (m_waiting)
+        {
+            const std::uint64_t ONE {1};
+            [[maybe_unused]] const auto WRITTEN = ::write(m_wakeFD, &ONE, sizeof(ONE));
+        }
+    }
+
+    // Expects m_mutex to be held.
+    void schedule(const StreamID ID, Stream& stream)
+    {
+        if (!stream.scheduled)
+        {
+            stream.scheduled = true;
+            m_sendOrder.push_back(ID);
+        }
+    }
+
+    // Expects m_mutex to be held. Dropping the streams releases their handlers, which fails pending call()s.
+    void failAllStreams()
+    {
+        m_closed = true;
+        m_streams.clear();
+        m_sendOrder.clear();
+    }
+
+    // Expects m_mutex to be held.
+    void eraseIfFinished(const StreamID ID, const Stream& stream)
+    {
+        if (stream.endSent && stream.remoteEnded && !stream.scheduled)
+        {
+            m_streams.erase(ID);
+        }
+    }
+
+    auto sendFrame(const FrameHeader& header, const std::string_view PAYLOAD) -> bool
+    {
+        std::array<char, HEADER_SIZE> encoded {};
+        encodeHeader(encoded, header);
+        const std::array<std::string_view, 2> PARTS {std::string_view {encoded.data(), encoded.size()}, PAYLOAD};
+        m_metrics.framesSent++;
+        return m_socket.sendGathered(PARTS) != -1;
+    }
+
+    // Writes control frames, then data frames round robin until the streams run dry or the socket backs up.
+    auto writeFrames() -> bool
+    {
+        const std::lock_guard LOCK {m_mutex};
+
+        for (const auto& [id, increment] : m_windowUpdates)
+        {
+            std::array<char, sizeof(std::uint32_t)> payload {};
+            const std::uint32_t                     NETWORK_INCREMENT = htonl(increment);
+            std::memcpy(payload.data(), &NETWORK_INCREMENT, sizeof(NETWORK_INCREMENT));
+            if (!sendFrame(
+                  FrameHeader {.streamID = id, .length = payload.size(), .type = EFrameType::WINDOW_UPDATE, .flags = 0},
+                  std::string_view {payload.data(), payload.size()}
+                ))
+            {
+                return false;
+            }
+        }
+        m_windowUpdates.clear();
+
+        for (const StreamID ID : m_resets)
+        {
+            if (!sendFrame(FrameHeader {.streamID = ID, .length = 0, .type = EFrameType::RESET, .flags = 0}, {}))
+            {
+                return false;
+            }
+        }
+        m_resets.clear();
+
+        while (!m_sendOrder.empty())
+        {
+            if (m_socket.getPendingBytes() >= m_config.sendHighWatermark)
+            {
+                m_metrics.socketStalls++;
+                break;
+            }
+
+            const StreamID ID = m_sendOrder.front();
+            m_sendOrder.pop_front();
+            const auto STREAM_IT = m_streams.find(ID);
+            if (STREAM_IT == m_streams.end())
+            {
+                continue;
+            }
+            Stream&           stream    = *STREAM_IT->second;
+            const std::size_t REMAINING = stream.sendBuffer.size() - stream.sendOffset;
+
+            if (REMAINING > 0 && stream.sendWindow <= 0)
+            {
+                // Rescheduled by the WINDOW_UPDATE that reopens the window.
+                m_metrics.flowControlStalls++;
+                stream.scheduled = false;
+                continue;
+            }
+
+            const std::size_t CHUNK = std::min(
+              {REMAINING, static_cast<std::size_t>(m_config.maxFrameSize), static_cast<std::size_t>(stream.sendWindow)}
+            );
+            const bool END = stream.endQueued && CHUNK == REMAINING;
+            if (!sendFrame(
+                  FrameHeader {
+                    .streamID = ID,
+                    .length   = static_cast<std::uint32_t>(CHUNK),
+                    .type     = EFrameType::DATA,
+                    .flags    = END ? FLAG_END_STREAM : std::uint8_t {0}
+              },
+                  std::string_view {stream.sendBuffer}.substr(stream.sendOffset, CHUNK)
+                ))
+            {
+                return false;
+            }
+
+            stream.sendOffset += CHUNK;
+            stream.sendWindow -= static_cast<std::int64_t>(CHUNK);
+            stream.endSent     = END;
+
+            const auto NOW     = Clock::now();
+            while (!stream.pendingMessages.empty() && stream.pendingMessages.front().end <= stream.sendOffset)
+            {
+                const auto DELAY = std::chrono::duration_cast<std::chrono::microseconds>(
+                  NOW - stream.pendingMessages.front().queuedAt
+                );
+                m_metrics.messagesSent++;
+                m_metrics.totalQueueDelay += DELAY;
+                m_metrics.maxQueueDelay    = std::max(m_metrics.maxQueueDelay, DELAY);
+                stream.pendingMessages.pop_front();
+            }
+
+            if (stream.sendOffset == stream.sendBuffer.size())
+            {
+                stream.sendBuffer.clear();
+                stream.sendOffset = 0;
+                stream.scheduled  = false;
+                eraseIfFinished(ID, stream);
+                continue;
+            }
+
+            if (stream.sendOffset >= m_config.maxFrameSize && stream.sendOffset * 2 >= stream.sendBuffer.size())
+            {
+                // Drop what was sent, keeps the buffer from growing on long lived streams.
+                stream.sendBuffer.erase(0, stream.sendOffset);
+                for (auto& message : stream.pendingMessages)
+                {
+                    message.end -= stream.sendOffset;
+                }
+                stream.sendOffset = 0;
+            }
+            m_sendOrder.push_back(ID);
+        }
+
+        return m_socket.flush() != -1;
+    }
+
+    // Handles one complete frame. Returns false on a protocol violation.
+    auto handleFrame(const FrameHeader& header, const std::string_view PAYLOAD) -> bool
+    {
+        std::shared_ptr<Stream> stream {};
+        {
+            const std::lock_guard LOCK {m_mutex};
+            m_metrics.framesReceived++;
+            const auto            STREAM_IT = m_streams.find(header.streamID);
+            if (STREAM_IT != m_streams.end())
+            {
+                stream = STREAM_IT->second;
+            }
+
+            switch (header.type)
+            {
+                case EFrameType::WINDOW_UPDATE:
+                {
+                    if (PAYLOAD.size() != sizeof(std::uint32_t))
+                    {
+                        return false;
+                    }
+                    if (stream)
+                    {
+                        std::uint32_t increment {};
+                        std::memcpy(&increment, PAYLOAD.data(), sizeof(increment));
+                        stream->sendWindow += ntohl(increment);
+                        if (stream->sendWindow > 0 && stream->sendOffset < stream->sendBuffer.size())
+                        {
+                            schedule(header.streamID, *stream);
+                        }
+                    }
+                    return true;
+                }
+                case EFrameType::RESET:
+                    // Dropping the stream releases its handler, which breaks the promise of a pending call().
+                    m_streams.erase(header.streamID);
+                    return true;
+                case EFrameType::DATA:
+                    break;
+                default:
+                    return false;
+            }
+
+            if (!stream)
+            {
+                if (!isPeerStream(header.streamID) || header.streamID <= m_lastPeerStreamID)
+                {
+                    // Late data for a stream that was reset or already finished.
+                    return true;
+                }
+                m_lastPeerStreamID = header.streamID;
+                const auto PEER_STREAMS = std::ranges::count_if(
+                  m_streams, [this](const auto& entry) { return isPeerStream(entry.first); }
+                );
+                if (static_cast<std::size_t>(PEER_STREAMS) >= m_config.maxConcurrentStreams)
+                {
+                    m_metrics.refusedStreams++;
+                    m_resets.push_back(header.streamID);
+                    return true;
+                }
+                stream                = std::make_shared<Stream>();
+                stream->handler       = m_streamHandler;
+                stream->sendWindow    = m_config.initialWindow;
+                stream->receiveWindow = m_config.initialWindow;
+                m_streams.emplace(header.streamID, stream);
+            }
+
+            stream->receiveWindow -= static_cast<std::int64_t>(PAYLOAD.size());
+            if (stream->receiveWindow < 0 || stream->remoteEnded)
+            {
+                return false;
+            }
+        }
+
+        const bool END = (header.flags & FLAG_END_STREAM) != 0;
+        if (stream->handler)
+        {
+            stream->handler(header.streamID, PAYLOAD, END);
+        }
+        else
+        {
+            stream->request.append(PAYLOAD);
+            if (END && m_requestHandler)
+            {
+                m_requestHandler(header.streamID, std::move(stream->request));
+            }
+        }
+
+        const std::lock_guard LOCK {m_mutex};
+        if (END)
+        {
+            stream->remoteEnded = true;
+            eraseIfFinished(header.streamID, *stream);
+            return true;
+        }
+        if (!stream->handler)
+        {
+            // Buffered data keeps its window, a request that used up all of it can never complete.
+            if (stream->receiveWindow == 0 && m_streams.erase(header.streamID) > 0)
+            {
+                m_metrics.refusedStreams++;
+                m_resets.push_back(header.streamID);
+            }
+            return true;
+        }
+        // The data was consumed by the handler, hand the window back once half of it is used up.
+        stream->receiveWindow  += static_cast<std::int64_t>(PAYLOAD.size());
+        stream->unacknowledged += static_cast<std::uint32_t>(PAYLOAD.size());
+        if (stream->unacknowledged >= m_config.initialWindow / 2)
+        {
+            m_windowUpdates.emplace_back(header.streamID, stream->unacknowledged);
+            stream->unacknowledged = 0;
+        }
+        return true;
+    }
+
+    auto readFrames() -> bool
+    {
+        while (m_socket.isOpen())
+        {
+            const std::size_t MAX_FRAME = HEADER_SIZE + m_config.maxFrameSize;
+            if (m_receiveBuffer.size() - m_receiveEnd < MAX_FRAME)
+            {
+                std::memmove(m_receiveBuffer.data(), m_receiveBuffer.data() + m_receiveBegin, m_receiveEnd - m_receiveBegin);
+                m_receiveEnd   -= m_receiveBegin;
+                m_receiveBegin  = 0;
+            }
+
+            const std::int64_t BYTES_READ = m_socket.recvInto(std::span<char> {m_receiveBuffer}.subspan(m_receiveEnd));
+            if (BYTES_READ <= 0)
+            {
+                return BYTES_READ == -1 && !m_socket.isError();
+            }
+            m_receiveEnd += static_cast<std::size_t>(BYTES_READ);
+
+            while (m_receiveEnd - m_receiveBegin >= HEADER_SIZE)
+            {
+                const FrameHeader HEADER = decodeHeader(m_receiveBuffer.data() + m_receiveBegin);
+                if (HEADER.length > m_config.maxFrameSize)
+                {
+                    return false;
+                }
+                if (m_receiveEnd - m_receiveBegin < HEADER_SIZE + HEADER.length)
+                {
+                    break;
+                }
+                const std::string_view PAYLOAD {m_receiveBuffer.data() + m_receiveBegin + HEADER_SIZE, HEADER.length};
+                if (!handleFrame(HEADER, PAYLOAD))
+                {
+                    return false;
+                }
+                m_receiveBegin += HEADER_SIZE + HEADER.length;
+            }
+            if (m_receiveBegin == m_receiveEnd)
+            {
+                m_receiveBegin = 0;
+                m_receiveEnd   = 0;
+            }
+        }
+        return false;
+    }
+
+  public:
+    MultiplexedConnection(TCPSocket&& socket, const ERole ROLE) : MultiplexedConnection(std::move(socket), ROLE, Config {}) {}
+
+    MultiplexedConnection(TCPSocket&& socket, const ERole ROLE, const Config& config)
+            : m_socket {std::move(socket)},
+              m_role {ROLE},
+              m_config {config},
+              m_nextStreamID {ROLE == ERole::CLIENT ? 1U : 2U},
+              m_wakeFD {::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+              m_receiveBuffer(static_cast<std::size_t>(2) * (HEADER_SIZE + config.maxFrameSize))
+    {
+        if (m_wakeFD == -1)
+        {
+            throw std::runtime_error("Unable to create eventfd");
+        }
+        m_socket.setBlocking(false);
+        m_socket.enableCoalescing(TCPSocket::CoalescingConfig {
+          .maxBufferedBytes = config.sendHighWatermark,
+          .maxDelay         = std::chrono::microseconds {0},
+          .noDelay          = true,
+        });
+    }
+
+    MultiplexedConnection(const MultiplexedConnection&)                     = delete;
+    auto operator= (const MultiplexedConnection&) -> MultiplexedConnection& = delete;
+    MultiplexedConnection(MultiplexedConnection&&)                          = delete;
+    auto operator= (MultiplexedConnection&&) -> MultiplexedConnection&      = delete;
+    ~MultiplexedConnection() { ::close(m_wakeFD); }
+
+    // Handler for every chunk of peer initiated streams. Takes precedence over setRequestHandler().
+    // Both handlers should be set before the first pump().
+    void setStreamHandler(StreamHandler handler)
+    {
+        const std::lock_guard LOCK {m_mutex};
+        m_streamHandler = std::move(handler);
+    }
+
+    // Handler for complete requests on peer initiated streams.
+    void setRequestHandler(RequestHandler handler)
+    {
+        const std::lock_guard LOCK {m_mutex};
+        m_requestHandler = std::move(handler);
+    }
+
+    // On a closed connection the handler is dropped right away and send() on the returned id fails.
+    auto openStream(StreamHandler handler) -> StreamID
+    {
+        const std::lock_guard LOCK {m_mutex};
+        const StreamID        ID = m_nextStreamID;
+        m_nextStreamID          += 2;
+        if (m_closed)
+        {
+            return ID;
+        }
+
+        auto stream           = std::make_shared<Stream>();
+        stream->handler       = std::move(handler);
+        stream->sendWindow    = m_config.initialWindow;
+        stream->receiveWindow = m_config.initialWindow;
+        m_streams.emplace(ID, std::move(stream));
+        return ID;
+    }
+
+    // Queues data on a stream, END_STREAM closes our side of it. Returns false if the stream is unknown or ended.
+    auto send(const StreamID ID, const std::string_view DATA, const bool END_STREAM = false) -> bool
+    {
+        const std::lock_guard LOCK {m_mutex};
+        const auto            STREAM_IT = m_streams.find(ID);
+        if (STREAM_IT == m_streams.end() || STREAM_IT->second->endQueued)
+        {
+            return false;
+        }
+        Stream& stream = *STREAM_IT->second;
+        stream.sendBuffer.append(DATA);
+        stream.pendingMessages.push_back(PendingMessage {.end = stream.sendBuffer.size(), .queuedAt = Clock::now()});
+        stream.endQueued = END_STREAM;
+        schedule(ID, stream);
+        wakePump();
+        return true;
+    }
+
+    // Sends REQUEST on a new stream. The future is fulfilled with the complete response, or holds a
+    // std::future_error (broken promise) if the stream is reset or the connection fails first.
+    auto call(const std::string_view REQUEST) -> std::future<std::string>
+    {
+        auto           promise  = std::make_shared<std::promise<std::string>>();
+        auto           response = std::make_shared<std::string>();
+        auto           future   = promise->get_future();
+        const StreamID ID       = openStream(
+          [promise = std::move(promise), response = std::move(response)](StreamID /*id*/, std::string_view data, bool endStream)
+          {
+              response->append(data);
+              if (endStream)
+              {
+                  promise->set_value(std::move(*response));
+              }
+          }
+        );
+        send(ID, REQUEST, true);
+        return future;
+    }
+
+    // Abandons a stream in both directions.
+    void reset(const StreamID ID)
+    {
+        const std::lock_guard LOCK {m_mutex};
+        if (m_streams.erase(ID) > 0)
+        {
+            m_resets.push_back(ID);
+            wakePump();
+        }
+    }
+
+    // One I/O iteration: waits up to TIMEOUT for the socket, reads and dispatches all complete frames and writes
+    // what the flow control windows allow. Returns false once the connection is gone, which also fails all
+    // outstanding calls.
+    auto pump(const std::chrono::milliseconds TIMEOUT) -> bool
+    {
+        if (!m_socket.isOpen())
+        {
+            const std::lock_guard LOCK {m_mutex};
+            failAllStreams();
+            return false;
+        }
+
+        // Streams stalled on their flow control window are not in m_sendOrder, so pending output always waits for
+        // the socket. Waiting for POLLOUT instead of polling with a zero timeout keeps a full socket from spinning.
+        bool hasOutput = m_socket.getPendingBytes() > 0;
+        {
+            const std::lock_guard LOCK {m_mutex};
+            hasOutput = hasOutput || !m_sendOrder.empty() || !m_windowUpdates.empty() || !m_resets.empty();
+            m_waiting = true;
+        }
+
+        std::array<pollfd, 2> pfds {
+          pollfd {
+            .fd      = m_socket.getFD(),
+            .events  = static_cast<short>(hasOutput ? POLLIN | POLLOUT : POLLIN),
+            .revents = 0,
+          },
+          pollfd {.fd = m_wakeFD, .events = POLLIN, .revents = 0},
+        };
+        const int READY = ::poll(pfds.data(), pfds.size(), static_cast<int>(TIMEOUT.count()));
+        if (READY == -1 && errno != EINTR)
+        {
+            m_socket.close();
+        }
+        {
+            const std::lock_guard LOCK {m_mutex};
+            m_waiting = false;
+        }
+        if (pfds[1].revents != 0)
+        {
+            std::uint64_t               wakeups {};
+            [[maybe_unused]] const auto BYTES_READ = ::read(m_wakeFD, &wakeups, sizeof(wakeups));
+        }
+
+        if (!readFrames() || !writeFrames())
+        {
+            m_socket.close();
+        }
+
+        if (!m_socket.isOpen())
+        {
+            const std::lock_guard LOCK {m_mutex};
+            failAllStreams();
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    auto getMetrics() const -> Metrics
+    {
+        const std::lock_guard LOCK {m_mutex};
+        Metrics               metrics = m_metrics;
+        metrics.openStreams           = m_streams.size();
+        return metrics;
+    }
+
+    [[nodiscard]]
+    auto isOpen() const noexcept -> bool
+    {
+        return m_socket.isOpen();
+    }
+
+    [[nodiscard]]
+    auto getSocket() const noexcept -> const TCPSocket&
+    {
+        return m_socket;
+    }
+};
+
+} // namespace CPPSockets
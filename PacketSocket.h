@@ -0,0 +1,425 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <utility>
+
+#include "Socket.h"
+
+namespace CPPSockets
+{
+
+// A captured frame, valid until the callback it was passed to returns.
+class PacketFrame
+{
+  private:
+    const tpacket3_hdr* m_header;
+
+  public:
+    explicit PacketFrame(const tpacket3_hdr* header) noexcept : m_header {header} {}
+
+    // The captured bytes starting at the link layer header, possibly truncated to the ring's frame size.
+    [[nodiscard]]
+    auto data() const noexcept -> std::span<const std::uint8_t>
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+        return {reinterpret_cast<const std::uint8_t*>(m_header) + m_header->tp_mac, m_header->tp_snaplen};
+    }
+
+    // Length of the frame on the wire.
+    [[nodiscard]]
+    auto getOriginalLength() const noexcept -> std::uint32_t
+    {
+        return m_header->tp_len;
+    }
+
+    [[nodiscard]]
+    auto getTimestamp() const noexcept -> std::chrono::nanoseconds
+    {
+        return std::chrono::seconds {m_header->tp_sec} + std::chrono::nanoseconds {m_header->tp_nsec};
+    }
+
+    [[nodiscard]]
+    auto isTruncated() const noexcept -> bool
+    {
+        return m_header->tp_snaplen < m_header->tp_len;
+    }
+};
+
+// AF_PACKET socket with memory mapped rings (TPACKET_V3).
+// Receiving hands out whole blocks of frames that the kernel filled, without a syscall or copy per packet, and
+// gives each block back once all its frames were processed. Transmitting fills frames of the TX ring and sends
+// all of them with a single syscall in flushTransmit(). Opening a packet socket requires CAP_NET_RAW.
+class PacketSocket : public Socket
+{
+  public:
+    struct RingConfig
+    {
+        // Must be a multiple of the page size and of frameSize.
+        std::uint32_t             blockSize {static_cast<std::uint32_t>(1) << 22};
+        std::uint32_t             blockCount {64};
+        // Maximum captured bytes per frame, including the kernel's frame header.
+        std::uint32_t             frameSize {2'048};
+        // The kernel hands a block to user space when it is full or after this timeout, whichever comes first.
+        std::chrono::milliseconds blockTimeout {10};
+        // Number of TX ring frames, 0 for no TX ring. Each frame takes frameSize bytes.
+        std::uint32_t             txFrameCount {0};
+    };
+
+    struct Statistics
+    {
+        std::uint32_t packets;
+        std::uint32_t drops;
+        // Times the kernel ran out of free blocks.
+        std::uint32_t queueFreezes;
+    };
+
+  private:
+    RingConfig    m_config;
+    std::uint8_t* m_ring {nullptr};
+    std::size_t   m_ringSize {0};
+    std::uint32_t m_currentBlock {0};
+    std::uint8_t* m_txRing {nullptr};
+    std::uint32_t m_txBlockSize {0};
+    std::uint32_t m_currentTxFrame {0};
+    std::uint32_t m_queuedTxFrames {0};
+    std::uint64_t m_txFormatErrors {0};
+
+    // Hands an RX block back to the kernel when it goes out of scope, also if a callback throws. Otherwise the
+    // kernel never gets the block back and capturing stalls once it comes around again.
+    class BlockRelease
+    {
+      private:
+        PacketSocket&       m_socket;
+        tpacket_block_desc* m_block;
+
+      public:
+        BlockRelease(PacketSocket& socket, tpacket_block_desc* block) noexcept : m_socket {socket}, m_block {block} {}
+
+        BlockRelease(const BlockRelease&)                     = delete;
+        auto operator= (const BlockRelease&) -> BlockRelease& = delete;
+        BlockRelease(BlockRelease&&)                          = delete;
+        auto operator= (BlockRelease&&) -> BlockRelease&      = delete;
+
+        ~BlockRelease()
+        {
+            __atomic_store_n(&m_block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+            m_socket.m_currentBlock = (m_socket.m_currentBlock + 1) % m_socket.m_config.blockCount;
+        }
+    };
+
+    [[nodiscard]]
+    auto blockAt(const std::uint32_t INDEX) const noexcept -> tpacket_block_desc*
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+        return reinterpret_cast<tpacket_block_desc*>(m_ring + static_cast<std::size_t>(INDEX) * m_config.blockSize);
+    }
+
+    [[nodiscard]]
+    auto txFrameAt(const std::uint32_t INDEX) const noexcept -> tpacket3_hdr*
+    {
+        const std::uint32_t FRAMES_PER_BLOCK = m_txBlockSize / m_config.frameSize;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+        return reinterpret_cast<tpacket3_hdr*>(
+          m_txRing + static_cast<std::size_t>(INDEX / FRAMES_PER_BLOCK) * m_txBlockSize
+          + static_cast<std::size_t>(INDEX % FRAMES_PER_BLOCK) * m_config.frameSize
+        );
+    }
+
+    void unmap() noexcept
+    {
+        if (m_ring != nullptr)
+        {
+            ::munmap(m_ring, m_ringSize);
+            m_ring   = nullptr;
+            m_txRing = nullptr;
+        }
+    }
+
+    void setupRings()
+    {
+        const int VERSION = TPACKET_V3;
+        if (setsockopt(getFD(), SOL_PACKET, PACKET_VERSION, &VERSION, sizeof(VERSION)) == -1)
+        {
+            throw std::runtime_error("Failed to set socket option PACKET_VERSION");
+        }
+
+        tpacket_req3 rxRequest {};
+        rxRequest.tp_block_size       = m_config.blockSize;
+        rxRequest.tp_block_nr         = m_config.blockCount;
+        rxRequest.tp_frame_size       = m_config.frameSize;
+        rxRequest.tp_frame_nr         = (m_config.blockSize / m_config.frameSize) * m_config.blockCount;
+        rxRequest.tp_retire_blk_tov   = static_cast<unsigned int>(m_config.blockTimeout.count());
+        rxRequest.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+        if (setsockopt(getFD(), SOL_PACKET, PACKET_RX_RING, &rxRequest, sizeof(rxRequest)) == -1)
+        {
+            throw std::runtime_error(std::format("Failed to set up RX ring: {}", std::strerror(errno)));
+        }
+        m_ringSize = static_cast<std::size_t>(m_config.blockSize) * m_config.blockCount;
+
+        std::size_t txSize {0};
+        if (m_config.txFrameCount > 0)
+        {
+            // TX rings only use the frame geometry, the kernel rejects the V3 block retire settings.
+            const std::uint32_t FRAMES_PER_BLOCK = m_config.blockSize / m_config.frameSize;
+            tpacket_req3        txRequest {};
+            txRequest.tp_block_size = m_config.blockSize;
+            txRequest.tp_block_nr   = (m_config.txFrameCount + FRAMES_PER_BLOCK - 1) / FRAMES_PER_BLOCK;
+            txRequest.tp_frame_size = m_config.frameSize;
+            txRequest.tp_frame_nr   = txRequest.tp_block_nr * FRAMES_PER_BLOCK;
+            if (setsockopt(getFD(), SOL_PACKET, PACKET_TX_RING, &txRequest, sizeof(txRequest)) == -1)
+            {
+                throw std::runtime_error(std::format("Failed to set up TX ring: {}", std::strerror(errno)));
+            }
+            m_config.txFrameCount = txRequest.tp_frame_nr;
+            m_txBlockSize         = m_config.blockSize;
+            txSize                = static_cast<std::size_t>(txRequest.tp_block_size) * txRequest.tp_block_nr;
+        }
+
+        // RX and TX ring share one mapping, TX directly behind RX.
+        void* mapping = ::mmap(nullptr, m_ringSize + txSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, getFD(), 0);
+        if (mapping == MAP_FAILED)
+        {
+            // MAP_LOCKED fails beyond RLIMIT_MEMLOCK, the ring works without it, just with possible page faults.
+            mapping = ::mmap(nullptr, m_ringSize + txSize, PROT_READ | PROT_WRITE, MAP_SHARED, getFD(), 0);
+        }
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("Failed to map packet rings");
+        }
+        m_ring     = static_cast<std::uint8_t*>(mapping);
+        m_ringSize += txSize;
+        m_txRing   = txSize > 0 ? m_ring + static_cast<std::size_t>(m_config.blockSize) * m_config.blockCount : nullptr;
+    }
+
+  public:
+    // Captures on the named interface, or on all interfaces if the name is empty.
+    explicit PacketSocket(const std::string& interfaceName) : PacketSocket(interfaceName, RingConfig {}) {}
+
+    PacketSocket(const std::string& interfaceName, const RingConfig& config)
+            : Socket(::socket(AF_PACKET, static_cast<int>(EProtocol::RAW), htons(ETH_P_ALL))),
+              m_config {config}
+    {
+        setupRings();
+
+        sockaddr_ll address {};
+        address.sll_family   = AF_PACKET;
+        address.sll_protocol = htons(ETH_P_ALL);
+        if (!interfaceName.empty())
+        {
+            address.sll_ifindex = static_cast<int>(if_nametoindex(interfaceName.c_str()));
+            if (address.sll_ifindex == 0)
+            {
+                unmap();
+                throw std::runtime_error(std::format("Unknown interface: {}", interfaceName));
+            }
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Marginally better than C.
+        if (bind(getFD(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1)
+        {
+            unmap();
+            throw std::runtime_error(std::format("Failed to bind packet socket to {}", interfaceName));
+        }
+
+        setStatus(ESocketStatus::OK);
+    }
+
+    PacketSocket(const PacketSocket&)                     = delete;
+    auto operator= (const PacketSocket&) -> PacketSocket& = delete;
+
+    PacketSocket(PacketSocket&& other) noexcept
+            : Socket(std::move(other)),
+              m_config {other.m_config},
+              m_ring {std::exchange(other.m_ring, nullptr)},
+              m_ringSize {std::exchange(other.m_ringSize, 0)},
+              m_currentBlock {other.m_currentBlock},
+              m_txRing {std::exchange(other.m_txRing, nullptr)},
+              m_txBlockSize {other.m_txBlockSize},
+              m_currentTxFrame {other.m_currentTxFrame},
+              m_queuedTxFrames {other.m_queuedTxFrames},
+              m_txFormatErrors {other.m_txFormatErrors}
+    {}
+
+    auto operator= (PacketSocket&& other) noexcept -> PacketSocket&
+    {
+        if (this != &other)
+        {
+            unmap();
+            Socket::operator= (std::move(other));
+            m_config         = other.m_config;
+            m_ring           = std::exchange(other.m_ring, nullptr);
+            m_ringSize       = std::exchange(other.m_ringSize, 0);
+            m_currentBlock   = other.m_currentBlock;
+            m_txRing         = std::exchange(other.m_txRing, nullptr);
+            m_txBlockSize    = other.m_txBlockSize;
+            m_currentTxFrame = other.m_currentTxFrame;
+            m_queuedTxFrames = other.m_queuedTxFrames;
+            m_txFormatErrors = other.m_txFormatErrors;
+        }
+        return *this;
+    }
+
+    ~PacketSocket() { unmap(); }
+
+    // Attaches a classic BPF program, e.g. from `tcpdump -dd <expression>`, so the kernel drops everything else
+    // before it reaches the ring.
+    void attachFilter(const std::span<const sock_filter> program) const
+    {
+        sock_fprog filter {
+          .len    = static_cast<unsigned short>(program.size()),
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast) // The kernel copies the program.
+          .filter = const_cast<sock_filter*>(program.data()),
+        };
+        if (setsockopt(getFD(), SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) == -1)
+        {
+            throw std::runtime_error("Failed to attach BPF filter");
+        }
+    }
+
+    void detachFilter() const
+    {
+        const int UNUSED {0};
+        if (setsockopt(getFD(), SOL_SOCKET, SO_DETACH_FILTER, &UNUSED, sizeof(UNUSED)) == -1)
+        {
+            throw std::runtime_error("Failed to detach BPF filter");
+        }
+    }
+
+    // Calls callback(const PacketFrame&) for every frame in every block that is ready, waiting up to TIMEOUT for
+    // the first one. Blocks are returned to the kernel right after their frames were processed, or when callback
+    // throws, in which case the rest of that block is skipped. Returns the number of frames processed.
+    template <typename Callback>
+    auto receive(Callback&& callback, const std::chrono::milliseconds TIMEOUT) -> std::size_t
+    {
+        std::size_t frames {};
+        while (true)
+        {
+            tpacket_block_desc* block = blockAt(m_currentBlock);
+            if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+            {
+                if (frames > 0)
+                {
+                    return frames;
+                }
+                pollfd    pfd {.fd = getFD(), .events = POLLIN | POLLERR, .revents = 0};
+                const int READY = ::poll(&pfd, 1, static_cast<int>(TIMEOUT.count()));
+                if (READY == -1 && errno != EINTR)
+                {
+                    setStatus(ESocketStatus::ERROR);
+                    return frames;
+                }
+                if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+                {
+                    return frames;
+                }
+            }
+
+            const BlockRelease  RELEASE {*this, block};
+            const std::uint32_t FRAME_COUNT = block->hdr.bh1.num_pkts;
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+            auto*               header = reinterpret_cast<const tpacket3_hdr*>(
+              reinterpret_cast<const std::uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt
+            );
+            for (std::uint32_t i = 0; i < FRAME_COUNT; ++i)
+            {
+                callback(PacketFrame {header});
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+                header = reinterpret_cast<const tpacket3_hdr*>(
+                  reinterpret_cast<const std::uint8_t*>(header) + header->tp_next_offset
+                );
+            }
+            frames += FRAME_COUNT;
+        }
+    }
+
+    // Copies a complete link layer frame into the next free TX ring slot. Nothing is sent before flushTransmit().
+    // Returns false if the frame does not fit into a slot or the ring is full. A slot the kernel rejected as
+    // malformed is counted in getTransmitFormatErrors() and reused.
+    auto queueTransmit(const std::span<const std::uint8_t> frame) noexcept -> bool
+    {
+        if (m_txRing == nullptr)
+        {
+            return false;
+        }
+        // The kernel takes the data right behind the aligned frame header.
+        static constexpr std::size_t DATA_OFFSET = TPACKET_ALIGN(sizeof(tpacket3_hdr));
+        if (frame.size() > m_config.frameSize - DATA_OFFSET)
+        {
+            return false;
+        }
+
+        tpacket3_hdr*  header = txFrameAt(m_currentTxFrame);
+        const unsigned STATUS = __atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE);
+        if (STATUS == TP_STATUS_WRONG_FORMAT)
+        {
+            // The kernel leaves such a slot alone forever, which would wedge the whole ring.
+            m_txFormatErrors++;
+        }
+        else if (STATUS != TP_STATUS_AVAILABLE)
+        {
+            return false;
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Ring layout is defined by the kernel.
+        std::memcpy(reinterpret_cast<std::uint8_t*>(header) + DATA_OFFSET, frame.data(), frame.size());
+        header->tp_len         = static_cast<std::uint32_t>(frame.size());
+        header->tp_next_offset = 0;
+        __atomic_store_n(&header->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+        m_currentTxFrame = (m_currentTxFrame + 1) % m_config.txFrameCount;
+        m_queuedTxFrames++;
+        return true;
+    }
+
+    // Sends every queued TX frame with one syscall. Returns the number of frames handed to the driver or -1.
+    auto flushTransmit() noexcept -> std::int64_t
+    {
+        if (m_queuedTxFrames == 0)
+        {
+            return 0;
+        }
+        if (::send(getFD(), nullptr, 0, 0) == -1)
+        {
+            setStatus(ESocketStatus::ERROR);
+            return -1;
+        }
+        return std::exchange(m_queuedTxFrames, 0);
+    }
+
+    // Frames the kernel refused to send because they were malformed, since the socket was opened.
+    [[nodiscard]]
+    auto getTransmitFormatErrors() const noexcept -> std::uint64_t
+    {
+        return m_txFormatErrors;
+    }
+
+    // Counters since the last call, the kernel resets them on every read.
+    [[nodiscard]]
+    auto getStatistics() const -> Statistics
+    {
+        tpacket_stats_v3 stats {};
+        socklen_t        length = sizeof(stats);
+        if (getsockopt(getFD(), SOL_PACKET, PACKET_STATISTICS, &stats, &length) == -1)
+        {
+            throw std::runtime_error("Failed to get packet statistics");
+        }
+        return Statistics {.packets = stats.tp_packets, .drops = stats.tp_drops, .queueFreezes = stats.tp_freeze_q_cnt};
+    }
+};
+
+} // namespace CPPSockets
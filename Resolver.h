@@ -0,0 +1,409 @@
+#pragma once
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <format>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <netdb.h>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "NetAddress.h"
+#include "Port.h"
+#include "Socket.h"
+#include "TCPSocket.h"
+
+namespace CPPSockets
+{
+
+struct ResolvedAddress
+{
+    NetAddress             address;
+    Socket::EAddressFamily family;
+};
+
+struct ResolveResult
+{
+    std::vector<ResolvedAddress> addresses;
+    // getaddrinfo error code, 0 on success.
+    int                          error {0};
+
+    [[nodiscard]]
+    auto isOk() const noexcept -> bool
+    {
+        return error == 0 && !addresses.empty();
+    }
+
+    [[nodiscard]]
+    auto getErrorMessage() const -> std::string
+    {
+        return error == 0 ? std::string {"no addresses"} : std::string {gai_strerror(error)};
+    }
+};
+
+// Resolves host names on its own worker threads, so that event loop threads never block in getaddrinfo.
+// Results are cached, failures too (negative caching), and concurrent lookups of the same name share one query.
+// getaddrinfo does not expose record TTLs, so entries live for the configured TTLs instead. Numeric addresses are
+// answered immediately without touching the workers or the cache.
+class Resolver
+{
+  public:
+    using Callback = std::function<void(const ResolveResult&)>;
+
+    struct Config
+    {
+        std::size_t          threads {2};
+        // Threads for connect(), kept apart so that connects to unreachable hosts never hold up name resolution.
+        std::size_t          connectThreads {2};
+        std::chrono::seconds positiveTTL {60};
+        std::chrono::seconds negativeTTL {5};
+        std::size_t          maxEntries {4'096};
+    };
+
+    struct Statistics
+    {
+        std::uint64_t cacheHits {0};
+        std::uint64_t negativeCacheHits {0};
+        std::uint64_t cacheMisses {0};
+        // Lookups that piggybacked on a query already in flight.
+        std::uint64_t coalesced {0};
+        std::uint64_t queries {0};
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct CacheEntry
+    {
+        std::shared_ptr<const ResolveResult> result;
+        Clock::time_point                    expires;
+    };
+
+    struct TaskQueue
+    {
+        std::condition_variable_any       condition;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    Config                                                 m_config;
+
+    std::mutex                                             m_mutex;
+    TaskQueue                                              m_queries;
+    TaskQueue                                              m_connects;
+    std::unordered_map<std::string, CacheEntry>            m_cache;
+    std::unordered_map<std::string, std::vector<Callback>> m_inFlight;
+    Statistics                                             m_statistics {};
+
+    // Last member, the workers must stop before anything they use is destroyed.
+    std::vector<std::jthread>                              m_workers;
+
+    static auto makeKey(const std::string& host, const int FAMILY) -> std::string
+    {
+        return std::format("{}/{}", FAMILY, host);
+    }
+
+    static auto toFamily(const std::optional<Socket::EAddressFamily>& family) noexcept -> int
+    {
+        return family.has_value() ? static_cast<int>(*family) : AF_UNSPEC;
+    }
+
+    // Parses numeric IPv4 and IPv6 addresses, which need neither a query nor a cache entry.
+    static auto tryNumeric(const std::string& host, const int FAMILY) -> std::optional<ResolveResult>
+    {
+        std::array<std::uint8_t, sizeof(in6_addr)> buffer {};
+        if ((FAMILY == AF_UNSPEC || FAMILY == AF_INET) && inet_pton(AF_INET, host.c_str(), buffer.data()) == 1)
+        {
+            return ResolveResult {.addresses = {ResolvedAddress {NetAddress {host}, Socket::EAddressFamily::IPV4}}, .error = 0};
+        }
+        if ((FAMILY == AF_UNSPEC || FAMILY == AF_INET6) && inet_pton(AF_INET6, host.c_str(), buffer.data()) == 1)
+        {
+            return ResolveResult {.addresses = {ResolvedAddress {NetAddress {host}, Socket::EAddressFamily::IPV6}}, .error = 0};
+        }
+        return std::nullopt;
+    }
+
+    static auto query(const std::string& host, const int FAMILY) -> ResolveResult
+    {
+        addrinfo hints {};
+        hints.ai_family   = FAMILY;
+        // One entry per address instead of one per socket type.
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = AI_ADDRCONFIG;
+
+        addrinfo*     list {nullptr};
+        ResolveResult result {};
+        result.error = getaddrinfo(host.c_str(), nullptr, &hints, &list);
+        if (result.error != 0)
+        {
+            return result;
+        }
+
+        for (const addrinfo* info = list; info != nullptr; info = info->ai_next)
+        {
+            std::array<char, INET6_ADDRSTRLEN> text {};
+            const void*                        address {nullptr};
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast) // Using c-style APIs is horror.
+            if (info->ai_family == AF_INET)
+            {
+                address = &reinterpret_cast<const sockaddr_in*>(info->ai_addr)->sin_addr;
+            }
+            else if (info->ai_family == AF_INET6)
+            {
+                address = &reinterpret_cast<const sockaddr_in6*>(info->ai_addr)->sin6_addr;
+            }
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (address == nullptr || inet_ntop(info->ai_family, address, text.data(), text.size()) == nullptr)
+            {
+                continue;
+            }
+            result.addresses.push_back(ResolvedAddress {
+              NetAddress {std::string {text.data()}},
+              static_cast<Socket::EAddressFamily>(info->ai_family),
+            });
+        }
+        freeaddrinfo(list);
+        return result;
+    }
+
+    // Expects m_mutex to be held.
+    void insertIntoCache(const std::string& key, const std::shared_ptr<const ResolveResult>& result)
+    {
+        const auto NOW = Clock::now();
+        if (m_cache.size() >= m_config.maxEntries)
+        {
+            std::erase_if(m_cache, [NOW](const auto& entry) { return entry.second.expires <= NOW; });
+        }
+        if (m_cache.size() >= m_config.maxEntries)
+        {
+            m_cache.erase(m_cache.begin());
+        }
+        const auto TTL = result->isOk() ? m_config.positiveTTL : m_config.negativeTTL;
+        m_cache.insert_or_assign(key, CacheEntry {.result = result, .expires = NOW + TTL});
+    }
+
+    void work(const std::stop_token& stopToken, TaskQueue& queue)
+    {
+        while (true)
+        {
+            std::function<void()> task {};
+            {
+                std::unique_lock lock {m_mutex};
+                // wait() still returns true after a stop request if tasks are queued, those are dropped instead.
+                if (!queue.condition.wait(lock, stopToken, [&queue]() { return !queue.tasks.empty(); })
+                    || stopToken.stop_requested())
+                {
+                    return;
+                }
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    // Expects m_mutex to be held.
+    static void post(TaskQueue& queue, std::function<void()> task)
+    {
+        queue.tasks.push_back(std::move(task));
+        queue.condition.notify_one();
+    }
+
+    void runQuery(const std::string& key, const std::string& host, const int FAMILY)
+    {
+        const auto            RESULT = std::make_shared<const ResolveResult>(query(host, FAMILY));
+
+        std::vector<Callback> waiters {};
+        {
+            const std::lock_guard LOCK {m_mutex};
+            // Transient failures are not cached, a short DNS hiccup must not turn into a negative TTL long outage.
+            if (RESULT->error != EAI_AGAIN && RESULT->error != EAI_MEMORY && RESULT->error != EAI_SYSTEM)
+            {
+                insertIntoCache(key, RESULT);
+            }
+            const auto WAITERS_IT = m_inFlight.find(key);
+            if (WAITERS_IT != m_inFlight.end())
+            {
+                waiters = std::move(WAITERS_IT->second);
+                m_inFlight.erase(WAITERS_IT);
+            }
+        }
+        for (const auto& waiter : waiters)
+        {
+            waiter(*RESULT);
+        }
+    }
+
+  public:
+    Resolver() : Resolver(Config {}) {}
+
+    explicit Resolver(const Config& config) : m_config {config}
+    {
+        const std::size_t QUERY_THREADS   = std::max<std::size_t>(config.threads, 1);
+        const std::size_t CONNECT_THREADS = std::max<std::size_t>(config.connectThreads, 1);
+        m_workers.reserve(QUERY_THREADS + CONNECT_THREADS);
+        for (std::size_t i = 0; i < QUERY_THREADS; ++i)
+        {
+            m_workers.emplace_back([this](const std::stop_token& stopToken) { work(stopToken, m_queries); });
+        }
+        for (std::size_t i = 0; i < CONNECT_THREADS; ++i)
+        {
+            m_workers.emplace_back([this](const std::stop_token& stopToken) { work(stopToken, m_connects); });
+        }
+    }
+
+    Resolver(const Resolver&)                     = delete;
+    auto operator= (const Resolver&) -> Resolver& = delete;
+    Resolver(Resolver&&)                          = delete;
+    auto operator= (Resolver&&) -> Resolver&      = delete;
+    // Queries and connects still queued are dropped, their futures break. A query or connect already in progress is
+    // waited for.
+    ~Resolver()
+    {
+        // Stop all workers before joining the first, otherwise the others keep taking queued tasks meanwhile.
+        for (auto& worker : m_workers)
+        {
+            worker.request_stop();
+        }
+        m_workers.clear();
+    }
+
+    // Answers from the cache without ever blocking, std::nullopt if the name still has to be resolved.
+    [[nodiscard]]
+    auto lookupCached(const std::string& host, const std::optional<Socket::EAddressFamily>& family = std::nullopt)
+      -> std::optional<ResolveResult>
+    {
+        const int FAMILY = toFamily(family);
+        if (auto numeric = tryNumeric(host, FAMILY))
+        {
+            return numeric;
+        }
+
+        const std::lock_guard LOCK {m_mutex};
+        const auto            ENTRY_IT = m_cache.find(makeKey(host, FAMILY));
+        if (ENTRY_IT == m_cache.end() || ENTRY_IT->second.expires <= Clock::now())
+        {
+            return std::nullopt;
+        }
+        (ENTRY_IT->second.result->isOk() ? m_statistics.cacheHits : m_statistics.negativeCacheHits)++;
+        return *ENTRY_IT->second.result;
+    }
+
+    // Calls callback with the result, right away on the calling thread if it is cached or numeric and otherwise
+    // on a resolver thread, which must not block for long.
+    void resolve(const std::string& host, const std::optional<Socket::EAddressFamily>& family, Callback callback)
+    {
+        if (auto cached = lookupCached(host, family))
+        {
+            callback(*cached);
+            return;
+        }
+
+        const int             FAMILY = toFamily(family);
+        std::string           key    = makeKey(host, FAMILY);
+        const std::lock_guard LOCK {m_mutex};
+        m_statistics.cacheMisses++;
+        auto& waiters = m_inFlight[key];
+        waiters.push_back(std::move(callback));
+        if (waiters.size() > 1)
+        {
+            m_statistics.coalesced++;
+            return;
+        }
+        m_statistics.queries++;
+        post(m_queries, [this, key = std::move(key), host, FAMILY]() { runQuery(key, host, FAMILY); });
+    }
+
+    [[nodiscard]]
+    auto resolve(const std::string& host, const std::optional<Socket::EAddressFamily>& family = std::nullopt)
+      -> std::future<ResolveResult>
+    {
+        auto promise = std::make_shared<std::promise<ResolveResult>>();
+        auto future  = promise->get_future();
+        resolve(host, family, [promise](const ResolveResult& result) { promise->set_value(result); });
+        return future;
+    }
+
+    // Resolves host and connects to the first address that accepts, on one of the connect threads. The future holds
+    // the connected socket, or a std::runtime_error if resolving or every connection attempt failed.
+    [[nodiscard]]
+    auto connect(
+      const std::string&                           host,
+      const Port&                                  port,
+      const bool                                   BLOCKING,
+      const std::optional<Socket::EAddressFamily>& family = std::nullopt
+    ) -> std::future<TCPSocket>
+    {
+        auto promise = std::make_shared<std::promise<TCPSocket>>();
+        auto future  = promise->get_future();
+        resolve(
+          host,
+          family,
+          [this, promise, host, port, BLOCKING](const ResolveResult& result)
+          {
+              if (!result.isOk())
+              {
+                  promise->set_exception(std::make_exception_ptr(
+                    std::runtime_error(std::format("Unable to resolve {}: {}", host, result.getErrorMessage()))
+                  ));
+                  return;
+              }
+              // Connecting blocks too, a cached answer must not make the caller wait for it and an unreachable host must
+              // not stall the queries.
+              const std::lock_guard LOCK {m_mutex};
+              post(
+                m_connects,
+                [promise, result, port, BLOCKING]()
+                {
+                    std::exception_ptr lastError {};
+                    for (const auto& resolved : result.addresses)
+                    {
+                        try
+                        {
+                            promise->set_value(TCPSocket(resolved.address, port, BLOCKING, resolved.family));
+                            return;
+                        }
+                        catch (...)
+                        {
+                            lastError = std::current_exception();
+                        }
+                    }
+                    promise->set_exception(lastError);
+                }
+              );
+          }
+        );
+        return future;
+    }
+
+    void clearCache()
+    {
+        const std::lock_guard LOCK {m_mutex};
+        m_cache.clear();
+    }
+
+    [[nodiscard]]
+    auto getStatistics() -> Statistics
+    {
+        const std::lock_guard LOCK {m_mutex};
+        return m_statistics;
+    }
+};
+
+} // namespace CPPSockets
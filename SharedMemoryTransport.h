@@ -0,0 +1,582 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <linux/futex.h>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+#include "Socket.h"
+#include "TCPSocket.h"
+#include "Transport.h"
+
+namespace CPPSockets
+{
+
+// Same host transport with the send/recv interface of TCPSocket.
+// The peers handshake over an ordinary TCPSocket, after which data moves through a pair of single producer single
+// consumer rings in a memfd both processes map, without any copies through the kernel. A reader that finds its
+// ring empty sleeps on a futex in the shared mapping and the writer wakes it only if it actually sleeps.
+//
+// The accepting side creates the memfd and tells the connecting side its pid and fd number, which then opens it
+// through /proc/<pid>/fd/<fd>. That requires both processes to run as the same user (ptrace access mode), as it is
+// the case for co-located services. The TCP connection stays open to detect a peer that dies without closing.
+class SharedMemoryTransport
+{
+  public:
+    static constexpr std::size_t DEFAULT_CAPACITY {static_cast<std::size_t>(1'024 * 1'024)};
+
+  private:
+    static constexpr std::uint32_t   HANDSHAKE_MAGIC {0x53484D31}; // "SHM1"
+    static constexpr std::size_t     CACHE_LINE {64};
+    // Interval in which a sleeping reader or writer checks whether the peer process is still alive.
+    static constexpr std::chrono::milliseconds LIVENESS_INTERVAL {100};
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared rings need address free atomics");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Shared rings need address free atomics");
+
+    struct RingHeader
+    {
+        // Total bytes ever written and read. Their difference is the fill level, their values modulo the capacity
+        // are the positions in the data area.
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> head;
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> tail;
+        // Futex words, bumped on every publish and consume.
+        alignas(CACHE_LINE) std::atomic<std::uint32_t> dataSequence;
+        std::atomic<std::uint32_t>                     readerWaiting;
+        alignas(CACHE_LINE) std::atomic<std::uint32_t> spaceSequence;
+        std::atomic<std::uint32_t>                     writerWaiting;
+        alignas(CACHE_LINE) std::atomic<std::uint32_t> closed;
+    };
+
+    struct Handshake
+    {
+        std::uint32_t magic;
+        std::int32_t  pid;
+        std::int32_t  fd;
+        std::uint32_t reserved;
+        std::uint64_t capacity;
+    };
+
+    TCPSocket                 m_socket;
+    int                       m_memFD {-1};
+    void*                     m_mapping {nullptr};
+    std::size_t               m_mappingSize {0};
+    std::size_t               m_capacity {0};
+    RingHeader*               m_sendRing {nullptr};
+    char*                     m_sendData {nullptr};
+    RingHeader*               m_receiveRing {nullptr};
+    char*                     m_receiveData {nullptr};
+    bool                      m_blocking {true};
+    Socket::ESocketStatus     m_status {Socket::ESocketStatus::INIT};
+
+    static auto ringStride(const std::size_t CAPACITY) noexcept -> std::size_t { return sizeof(RingHeader) + CAPACITY; }
+
+    static auto futexWait(std::atomic<std::uint32_t>& word, const std::uint32_t EXPECTED) noexcept -> void
+    {
+        const auto SECONDS     = std::chrono::duration_cast<std::chrono::seconds>(LIVENESS_INTERVAL);
+        const auto NANOSECONDS = std::chrono::duration_cast<std::chrono::nanoseconds>(LIVENESS_INTERVAL - SECONDS);
+        timespec   timeout {
+          .tv_sec  = static_cast<time_t>(SECONDS.count()),
+          .tv_nsec = static_cast<long>(NANOSECONDS.count())
+        };
+        // Not FUTEX_PRIVATE_FLAG, the word is shared with another process.
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) // No libc wrapper for futex.
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, EXPECTED, &timeout, nullptr, 0);
+    }
+
+    static auto futexWake(std::atomic<std::uint32_t>& word) noexcept -> void
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) // No libc wrapper for futex.
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    explicit SharedMemoryTransport(TCPSocket&& socket) : m_socket {std::move(socket)} {}
+
+    // Bytes the peer wrote that were not read yet.
+    [[nodiscard]]
+    auto getAvailable() const noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(
+          m_receiveRing->head.load(std::memory_order_acquire) - m_receiveRing->tail.load(std::memory_order_relaxed)
+        );
+    }
+
+    void map(const int MEM_FD, const std::size_t CAPACITY, const bool CREATOR)
+    {
+        m_memFD       = MEM_FD;
+        m_capacity    = CAPACITY;
+        m_mappingSize = 2 * ringStride(CAPACITY);
+        m_mapping     = ::mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, MEM_FD, 0);
+        if (m_mapping == MAP_FAILED)
+        {
+            m_mapping = nullptr;
+            throw std::runtime_error("Unable to map shared memory");
+        }
+
+        auto* base  = static_cast<char*>(m_mapping);
+        auto* first = base;
+        auto* second = base + ringStride(CAPACITY);
+        if (CREATOR)
+        {
+            // Fresh memfd pages are zeroed, constructing the headers only makes that official.
+            new (first) RingHeader {};
+            new (second) RingHeader {};
+        }
+        else
+        {
+            std::swap(first, second);
+        }
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast) // Objects were created by the accepting side.
+        m_sendRing    = reinterpret_cast<RingHeader*>(first);
+        m_receiveRing = reinterpret_cast<RingHeader*>(second);
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+        m_sendData    = first + sizeof(RingHeader);
+        m_receiveData = second + sizeof(RingHeader);
+    }
+
+    void sendHandshake(const Handshake& handshake)
+    {
+        if (::send(m_socket.getFD(), &handshake, sizeof(handshake), 0) != static_cast<ssize_t>(sizeof(handshake)))
+        {
+            throw std::runtime_error("Shared memory handshake failed to send");
+        }
+    }
+
+    auto receiveHandshake() -> Handshake
+    {
+        Handshake handshake {};
+        const ssize_t BYTES_READ = ::recv(m_socket.getFD(), &handshake, sizeof(handshake), MSG_WAITALL);
+        if (BYTES_READ != static_cast<ssize_t>(sizeof(handshake)) || handshake.magic != HANDSHAKE_MAGIC)
+        {
+            throw std::runtime_error("Shared memory handshake failed to receive");
+        }
+        return handshake;
+    }
+
+    // Whether the peer closed the transport. Only looks at the shared flag, the TCP connection is consulted after
+    // a wait timed out, so the fast paths stay free of syscalls.
+    [[nodiscard]]
+    static auto isClosed(const RingHeader& ring) noexcept -> bool
+    {
+        return ring.closed.load(std::memory_order_acquire) != 0;
+    }
+
+    // Sleeps on a ring's futex word unless CONDITION already changed. Returns false if the peer turned out to be
+    // gone while waiting.
+    template <typename Condition>
+    auto wait(std::atomic<std::uint32_t>& sequence, std::atomic<std::uint32_t>& waiting, Condition&& condition) noexcept
+      -> bool
+    {
+        const std::uint32_t SEQUENCE = sequence.load();
+        waiting.store(1);
+        if (!condition())
+        {
+            waiting.store(0);
+            return true;
+        }
+        futexWait(sequence, SEQUENCE);
+        waiting.store(0);
+        if (sequence.load() == SEQUENCE && m_socket.queryConnectionClosed())
+        {
+            // Nothing happened for a whole liveness interval and the process on the other end is gone.
+            m_status = Socket::ESocketStatus::DISCONNECTED;
+            return false;
+        }
+        return true;
+    }
+
+  public:
+    // Accepting side of the handshake, called on a freshly accepted connection from a process on the same host.
+    // CAPACITY is rounded up to a power of two and used for each direction.
+    [[nodiscard]]
+    static auto accept(TCPSocket&& socket, const std::size_t CAPACITY = DEFAULT_CAPACITY) -> SharedMemoryTransport
+    {
+        SharedMemoryTransport transport(std::move(socket));
+        transport.m_socket.setBlocking(true);
+
+        const std::size_t ROUNDED_CAPACITY = std::bit_ceil(CAPACITY);
+        const int         MEM_FD           = ::memfd_create("cppsockets-shm", MFD_CLOEXEC);
+        if (MEM_FD == -1)
+        {
+            throw std::runtime_error("Unable to create memfd");
+        }
+        if (::ftruncate(MEM_FD, static_cast<off_t>(2 * ringStride(ROUNDED_CAPACITY))) == -1)
+        {
+            ::close(MEM_FD);
+            throw std::runtime_error("Unable to size memfd");
+        }
+        transport.map(MEM_FD, ROUNDED_CAPACITY, true);
+
+        transport.sendHandshake(Handshake {
+          .magic = HANDSHAKE_MAGIC, .pid = ::getpid(), .fd = MEM_FD, .reserved = 0, .capacity = ROUNDED_CAPACITY
+        });
+        // The acknowledgement tells us the peer has its own reference, the memfd can't go away beneath it anymore.
+        transport.receiveHandshake();
+
+        transport.m_status = Socket::ESocketStatus::CONNECTED;
+        return transport;
+    }
+
+    // Connecting side of the handshake, called on a connection to a server that calls accept().
+    [[nodiscard]]
+    static auto connect(TCPSocket&& socket) -> SharedMemoryTransport
+    {
+        SharedMemoryTransport transport(std::move(socket));
+        transport.m_socket.setBlocking(true);
+
+        const Handshake   HELLO = transport.receiveHandshake();
+        const std::string PATH  = std::format("/proc/{}/fd/{}", HELLO.pid, HELLO.fd);
+        const int         MEM_FD = ::open(PATH.c_str(), O_RDWR | O_CLOEXEC);
+        if (MEM_FD == -1)
+        {
+            throw std::runtime_error(
+              std::format("Unable to open shared memory of peer at {}, is it on this host?", PATH)
+            );
+        }
+
+        struct stat fileStat {};
+        if (::fstat(MEM_FD, &fileStat) == -1
+            || static_cast<std::size_t>(fileStat.st_size) != 2 * ringStride(static_cast<std::size_t>(HELLO.capacity))
+            || !std::has_single_bit(HELLO.capacity))
+        {
+            ::close(MEM_FD);
+            throw std::runtime_error("Shared memory of peer has an unexpected size");
+        }
+        transport.map(MEM_FD, static_cast<std::size_t>(HELLO.capacity), false);
+
+        transport.sendHandshake(Handshake {
+          .magic = HANDSHAKE_MAGIC, .pid = ::getpid(), .fd = -1, .reserved = 0, .capacity = HELLO.capacity
+        });
+
+        transport.m_status = Socket::ESocketStatus::CONNECTED;
+        return transport;
+    }
+
+    SharedMemoryTransport(const SharedMemoryTransport&)                     = delete;
+    auto operator= (const SharedMemoryTransport&) -> SharedMemoryTransport& = delete;
+
+    SharedMemoryTransport(SharedMemoryTransport&& other) noexcept
+            : m_socket {std::move(other.m_socket)},
+              m_memFD {std::exchange(other.m_memFD, -1)},
+              m_mapping {std::exchange(other.m_mapping, nullptr)},
+              m_mappingSize {std::exchange(other.m_mappingSize, 0)},
+              m_capacity {other.m_capacity},
+              m_sendRing {std::exchange(other.m_sendRing, nullptr)},
+              m_sendData {std::exchange(other.m_sendData, nullptr)},
+              m_receiveRing {std::exchange(other.m_receiveRing, nullptr)},
+              m_receiveData {std::exchange(other.m_receiveData, nullptr)},
+              m_blocking {other.m_blocking},
+              m_status {std::exchange(other.m_status, Socket::ESocketStatus::INVALID)}
+    {}
+
+    auto operator= (SharedMemoryTransport&& other) noexcept -> SharedMemoryTransport&
+    {
+        if (this != &other)
+        {
+            close();
+            m_socket      = std::move(other.m_socket);
+            m_memFD       = std::exchange(other.m_memFD, -1);
+            m_mapping     = std::exchange(other.m_mapping, nullptr);
+            m_mappingSize = std::exchange(other.m_mappingSize, 0);
+            m_capacity    = other.m_capacity;
+            m_sendRing    = std::exchange(other.m_sendRing, nullptr);
+            m_sendData    = std::exchange(other.m_sendData, nullptr);
+            m_receiveRing = std::exchange(other.m_receiveRing, nullptr);
+            m_receiveData = std::exchange(other.m_receiveData, nullptr);
+            m_blocking    = other.m_blocking;
+            m_status      = std::exchange(other.m_status, Socket::ESocketStatus::INVALID);
+        }
+        return *this;
+    }
+
+    ~SharedMemoryTransport() { close(); }
+
+    void close() noexcept
+    {
+        if (m_mapping != nullptr)
+        {
+            // Tell the peer in both directions and wake it in case it sleeps on either ring.
+            for (RingHeader* ring : {m_sendRing, m_receiveRing})
+            {
+                ring->closed.store(1, std::memory_order_release);
+                ring->dataSequence.fetch_add(1);
+                ring->spaceSequence.fetch_add(1);
+                futexWake(ring->dataSequence);
+                futexWake(ring->spaceSequence);
+            }
+            ::munmap(m_mapping, m_mappingSize);
+            m_mapping     = nullptr;
+            m_sendRing    = nullptr;
+            m_sendData    = nullptr;
+            m_receiveRing = nullptr;
+            m_receiveData = nullptr;
+        }
+        if (m_memFD != -1)
+        {
+            ::close(m_memFD);
+            m_memFD = -1;
+        }
+        m_socket.close();
+        if (m_status == Socket::ESocketStatus::CONNECTED)
+        {
+            m_status = Socket::ESocketStatus::DISCONNECTED;
+        }
+    }
+
+    [[nodiscard]]
+    auto getStatus() const noexcept -> Socket::ESocketStatus
+    {
+        return m_status;
+    }
+
+    [[nodiscard]]
+    auto isOpen() const noexcept -> bool
+    {
+        return m_status == Socket::ESocketStatus::CONNECTED;
+    }
+
+    [[nodiscard]]
+    auto isError() const noexcept -> bool
+    {
+        return m_status == Socket::ESocketStatus::ERROR;
+    }
+
+    [[nodiscard]]
+    auto isBlocking() const noexcept -> bool
+    {
+        return m_blocking;
+    }
+
+    void setBlocking(const bool BLOCKING) noexcept { m_blocking = BLOCKING; }
+
+    // Checks the TCP connection of the handshake, for non-blocking users that never wait and still want to notice a
+    // peer process that died without closing the transport.
+    [[nodiscard]]
+    auto queryConnectionClosed() noexcept -> bool
+    {
+        if (isOpen() && (isClosed(*m_receiveRing) || m_socket.queryConnectionClosed()))
+        {
+            m_status = Socket::ESocketStatus::DISCONNECTED;
+        }
+        return !isOpen();
+    }
+
+    [[nodiscard]]
+    auto getCapacity() const noexcept -> std::size_t
+    {
+        return m_capacity;
+    }
+
+    // Copies data into the ring. A blocking transport waits for space until everything is written, a non-blocking
+    // one writes what fits. Returns the number of bytes written, or -1 if the connection is closed or, on a
+    // non-blocking transport, the ring is full.
+    auto send(const std::string_view DATA) noexcept -> std::int64_t
+    {
+        std::size_t written {};
+        while (written < DATA.size())
+        {
+            if (m_status != Socket::ESocketStatus::CONNECTED || isClosed(*m_sendRing))
+            {
+                if (m_status == Socket::ESocketStatus::CONNECTED)
+                {
+                    m_status = Socket::ESocketStatus::DISCONNECTED;
+                }
+                return written > 0 ? static_cast<std::int64_t>(written) : -1;
+            }
+
+            const std::uint64_t HEAD  = m_sendRing->head.load(std::memory_order_relaxed);
+            const std::uint64_t TAIL  = m_sendRing->tail.load(std::memory_order_acquire);
+            const std::size_t   FREE  = m_capacity - static_cast<std::size_t>(HEAD - TAIL);
+            if (FREE == 0)
+            {
+                if (!m_blocking)
+                {
+                    return written > 0 ? static_cast<std::int64_t>(written) : -1;
+                }
+                wait(
+                  m_sendRing->spaceSequence,
+                  m_sendRing->writerWaiting,
+                  [this, TAIL]() { return m_sendRing->tail.load() == TAIL && !isClosed(*m_sendRing); }
+                );
+                continue;
+            }
+
+            const std::size_t CHUNK    = std::min(FREE, DATA.size() - written);
+            const std::size_t POSITION = static_cast<std::size_t>(HEAD) & (m_capacity - 1);
+            const std::size_t FIRST    = std::min(CHUNK, m_capacity - POSITION);
+            std::memcpy(m_sendData + POSITION, DATA.data() + written, FIRST);
+            std::memcpy(m_sendData, DATA.data() + written + FIRST, CHUNK - FIRST);
+            written += CHUNK;
+
+            m_sendRing->head.store(HEAD + CHUNK);
+            m_sendRing->dataSequence.fetch_add(1);
+            if (m_sendRing->readerWaiting.load() != 0)
+            {
+                futexWake(m_sendRing->dataSequence);
+            }
+        }
+        return static_cast<std::int64_t>(written);
+    }
+
+    // Sends the parts back to back, like TCPSocket::sendGathered(). Stops at the first part that did not fit.
+    auto sendGathered(const std::span<const std::string_view> parts) noexcept -> std::int64_t
+    {
+        std::size_t written {};
+        for (const std::string_view PART : parts)
+        {
+            const std::int64_t SENT = send(PART);
+            if (SENT == -1)
+            {
+                return written > 0 ? static_cast<std::int64_t>(written) : -1;
+            }
+            written += static_cast<std::size_t>(SENT);
+            if (static_cast<std::size_t>(SENT) < PART.size())
+            {
+                break;
+            }
+        }
+        return static_cast<std::int64_t>(written);
+    }
+
+    // Nothing is ever held back, send() publishes to the ring right away.
+    auto flush() noexcept -> std::int64_t { return 0; }
+
+    [[nodiscard]]
+    auto getPendingBytes() const noexcept -> std::size_t
+    {
+        return 0;
+    }
+
+    // Whether a read would return without waiting, which includes the peer having closed the transport.
+    [[nodiscard]]
+    auto hasData() noexcept -> bool
+    {
+        return m_mapping != nullptr && (getAvailable() > 0 || isClosed(*m_receiveRing));
+    }
+
+    // Copies up to buffer.size() available bytes out of the ring, waiting for data on a blocking transport.
+    // Returns the number of bytes read, 0 if the peer closed the connection or -1 if nothing was available, the
+    // transport is closed or buffer is empty.
+    auto recvInto(const std::span<char> buffer) noexcept -> std::int64_t
+    {
+        if (m_mapping == nullptr || buffer.empty())
+        {
+            return -1;
+        }
+        while (true)
+        {
+            const std::uint64_t TAIL      = m_receiveRing->tail.load(std::memory_order_relaxed);
+            const std::uint64_t HEAD      = m_receiveRing->head.load(std::memory_order_acquire);
+            const auto          AVAILABLE = static_cast<std::size_t>(HEAD - TAIL);
+            if (AVAILABLE > 0)
+            {
+                const std::size_t CHUNK    = std::min(AVAILABLE, buffer.size());
+                const std::size_t POSITION = static_cast<std::size_t>(TAIL) & (m_capacity - 1);
+                const std::size_t FIRST    = std::min(CHUNK, m_capacity - POSITION);
+                std::memcpy(buffer.data(), m_receiveData + POSITION, FIRST);
+                std::memcpy(buffer.data() + FIRST, m_receiveData, CHUNK - FIRST);
+
+                m_receiveRing->tail.store(TAIL + CHUNK);
+                m_receiveRing->spaceSequence.fetch_add(1);
+                if (m_receiveRing->writerWaiting.load() != 0)
+                {
+                    futexWake(m_receiveRing->spaceSequence);
+                }
+                return static_cast<std::int64_t>(CHUNK);
+            }
+
+            if (m_status != Socket::ESocketStatus::CONNECTED)
+            {
+                return 0;
+            }
+            if (isClosed(*m_receiveRing))
+            {
+                // Drain what was written before the close first.
+                if (m_receiveRing->head.load() == TAIL)
+                {
+                    m_status = Socket::ESocketStatus::DISCONNECTED;
+                    return 0;
+                }
+                continue;
+            }
+            if (!m_blocking)
+            {
+                return -1;
+            }
+
+            const bool WOKEN = wait(
+              m_receiveRing->dataSequence,
+              m_receiveRing->readerWaiting,
+              [this, TAIL]() { return m_receiveRing->head.load() == TAIL && !isClosed(*m_receiveRing); }
+            );
+            if (!WOKEN)
+            {
+                return 0;
+            }
+        }
+    }
+
+    // Same contract as TCPSocket::recv(): returns everything available, std::nullopt if there is nothing.
+    [[nodiscard]]
+    auto recv() noexcept -> std::optional<std::string>
+    {
+        static constexpr std::size_t FIRST_READ_SIZE {4'096};
+        try
+        {
+            std::string data {};
+            std::size_t available = m_mapping != nullptr ? getAvailable() : 0;
+            if (available == 0)
+            {
+                // Lets recvInto() do the waiting on a blocking transport, then takes whatever arrived in the meantime.
+                std::array<char, FIRST_READ_SIZE> first {};
+                const std::int64_t                BYTES_READ = recvInto(first);
+                if (BYTES_READ <= 0)
+                {
+                    return std::nullopt;
+                }
+                data.assign(first.data(), static_cast<std::size_t>(BYTES_READ));
+                available = getAvailable();
+            }
+
+            const std::size_t OFFSET = data.size();
+            data.resize(OFFSET + available);
+            if (available > 0)
+            {
+                // Cannot wait, at least available bytes are in the ring.
+                const std::int64_t BYTES_READ = recvInto(std::span<char> {data}.subspan(OFFSET));
+                data.resize(OFFSET + static_cast<std::size_t>(std::max<std::int64_t>(BYTES_READ, 0)));
+            }
+            return data;
+        }
+        catch (...)
+        {
+            m_status = Socket::ESocketStatus::ERROR;
+            return std::nullopt;
+        }
+    }
+};
+
+static_assert(StreamConnection<SharedMemoryTransport>);
+
+} // namespace CPPSockets
@@ -0,0 +1,838 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <functional>
+#include <map>
+#include <optional>
+#include <queue>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Port.h"
+#include "Socket.h"
+#include "Transport.h"
+
+namespace CPPSockets
+{
+
+class SimulatedNetwork;
+
+// Virtual time of a SimulatedNetwork. It only moves when the network is advanced, so runs are reproducible.
+class SimulatedClock
+{
+  public:
+    using Duration  = std::chrono::nanoseconds;
+    using TimePoint = std::chrono::nanoseconds;
+
+  private:
+    TimePoint m_now {0};
+
+  public:
+    [[nodiscard]]
+    auto now() const noexcept -> TimePoint
+    {
+        return m_now;
+    }
+
+    void advance(const Duration DURATION) noexcept { m_now += DURATION; }
+
+    void advanceTo(const TimePoint TIME_POINT) noexcept { m_now = std::max(m_now, TIME_POINT); }
+};
+
+// A connection of a SimulatedNetwork. Same interface and return value conventions as a non-blocking TCPSocket, so
+// it satisfies StreamConnection and can stand in for one in HTTPSession and other protocol code.
+// Sends are never short, the simulated peer buffers without limit. The network must outlive its connections.
+class SimulatedConnection
+{
+    friend class SimulatedNetwork;
+
+  public:
+    using ESocketStatus = Socket::ESocketStatus;
+
+  private:
+    SimulatedNetwork* m_network {nullptr};
+    std::uint32_t     m_index {0};
+    std::uint32_t     m_generation {0};
+    ESocketStatus     m_status {ESocketStatus::INIT};
+
+    SimulatedConnection(SimulatedNetwork* network, const std::uint32_t INDEX, const std::uint32_t GENERATION)
+      : m_network {network}, m_index {INDEX}, m_generation {GENERATION}, m_status {ESocketStatus::CONNECTED}
+    {}
+
+  public:
+    SimulatedConnection() = default;
+
+    SimulatedConnection(const SimulatedConnection&)                     = delete;
+    auto operator= (const SimulatedConnection&) -> SimulatedConnection& = delete;
+
+    SimulatedConnection(SimulatedConnection&& other) noexcept
+      : m_network {std::exchange(other.m_network, nullptr)},
+        m_index {other.m_index},
+        m_generation {other.m_generation},
+        m_status {std::exchange(other.m_status, ESocketStatus::INIT)}
+    {}
+
+    auto operator= (SimulatedConnection&& other) noexcept -> SimulatedConnection&
+    {
+        if (this != &other)
+        {
+            close();
+            m_network    = std::exchange(other.m_network, nullptr);
+            m_index      = other.m_index;
+            m_generation = other.m_generation;
+            m_status     = std::exchange(other.m_status, ESocketStatus::INIT);
+        }
+        return *this;
+    }
+
+    ~SimulatedConnection() { close(); }
+
+    inline void close() noexcept;
+
+    inline auto send(std::string_view data) noexcept -> std::int64_t;
+
+    auto send(const std::string& data) noexcept -> std::int64_t { return send(std::string_view {data}); }
+
+    inline auto sendGathered(std::span<const std::string_view> parts) noexcept -> std::int64_t;
+
+    inline auto recvInto(std::span<char> buffer) noexcept -> std::int64_t;
+
+    [[nodiscard]]
+    inline auto recv() noexcept -> std::optional<std::string>;
+
+    [[nodiscard]]
+    inline auto hasData() noexcept -> bool;
+
+    [[nodiscard]]
+    inline auto queryConnectionClosed() noexcept -> bool;
+
+    // Nothing is ever held back, sends go onto the simulated link right away.
+    auto flush() noexcept -> std::int64_t { return 0; }
+
+    [[nodiscard]]
+    auto getPendingBytes() const noexcept -> std::size_t
+    {
+        return 0;
+    }
+
+    [[nodiscard]]
+    auto getStatus() const noexcept -> ESocketStatus
+    {
+        return m_status;
+    }
+
+    [[nodiscard]]
+    auto isOpen() const noexcept -> bool
+    {
+        return m_status == ESocketStatus::CONNECTED;
+    }
+
+    [[nodiscard]]
+    auto isError() const noexcept -> bool
+    {
+        return m_status == ESocketStatus::ERROR;
+    }
+
+    [[nodiscard]]
+    auto isBlocking() const noexcept -> bool
+    {
+        return false;
+    }
+};
+
+class SimulatedListener
+{
+    friend class SimulatedNetwork;
+
+  private:
+    SimulatedNetwork* m_network {nullptr};
+    Port              m_port {};
+
+    SimulatedListener(SimulatedNetwork* network, const Port& port) : m_network {network}, m_port {port} {}
+
+  public:
+    SimulatedListener(const SimulatedListener&)                     = delete;
+    auto operator= (const SimulatedListener&) -> SimulatedListener& = delete;
+
+    SimulatedListener(SimulatedListener&& other) noexcept
+      : m_network {std::exchange(other.m_network, nullptr)}, m_port {other.m_port}
+    {}
+
+    auto operator= (SimulatedListener&& other) noexcept -> SimulatedListener&
+    {
+        if (this != &other)
+        {
+            close();
+            m_network = std::exchange(other.m_network, nullptr);
+            m_port    = other.m_port;
+        }
+        return *this;
+    }
+
+    ~SimulatedListener() { close(); }
+
+    // Never blocks, std::nullopt if no connection attempt has arrived yet.
+    [[nodiscard]]
+    inline auto accept() -> std::optional<SimulatedConnection>;
+
+    inline void close() noexcept;
+
+    [[nodiscard]]
+    auto getPort() const noexcept -> Port
+    {
+        return m_port;
+    }
+};
+
+// Pure in-process network for reproducible tests and for measuring the library's own per-message cost without the
+// kernel. Every connection direction is a link with the configured latency and bandwidth. Segments may be lost,
+// which delays them by the retransmit timeout, or reordered, which delays them past later ones. The receiving end
+// reassembles in order like TCP does, so streams stay reliable and only the timing suffers.
+// All randomness comes from a seeded generator and time only moves in advance(), so identical runs produce
+// identical results. Connections are cheap: a few hundred bytes each, no file descriptors, no kernel limits.
+// Not thread safe, the network and all its connections belong to one thread.
+class SimulatedNetwork
+{
+    friend class SimulatedConnection;
+    friend class SimulatedListener;
+
+  public:
+    using Duration  = SimulatedClock::Duration;
+    using TimePoint = SimulatedClock::TimePoint;
+
+    struct LinkConfig
+    {
+        Duration      latency {std::chrono::microseconds {50}};
+        // Bytes per second and direction, 0 for unlimited.
+        std::uint64_t bandwidth {0};
+        // Chance that a segment is lost, in [0, 1). Every loss is retransmitted, so losses can repeat.
+        double        lossRate {0.0};
+        Duration      retransmitTimeout {std::chrono::milliseconds {200}};
+        // In [0, 1].
+        double        reorderRate {0.0};
+        Duration      reorderDelay {std::chrono::microseconds {100}};
+        std::size_t   maxSegmentSize {1'448};
+        std::uint64_t seed {1};
+    };
+
+    struct Statistics
+    {
+        std::uint64_t connections {0};
+        std::uint64_t refused {0};
+        std::uint64_t segments {0};
+        std::uint64_t bytes {0};
+        std::uint64_t retransmissions {0};
+        std::uint64_t reordered {0};
+        std::uint64_t dropped {0};
+    };
+
+  private:
+    static constexpr std::uint32_t NO_ENDPOINT {~std::uint32_t {0}};
+
+    enum class ESegmentType : std::uint8_t
+    {
+        SYN,
+        DATA,
+        FIN
+    };
+
+    struct Segment
+    {
+        TimePoint     deliverAt;
+        // Tie breaker, keeps delivery order independent of the heap implementation.
+        std::uint64_t order;
+        std::uint32_t target;
+        std::uint32_t generation;
+        std::uint64_t sequence;
+        ESegmentType  type;
+        std::string   data;
+
+        auto          operator> (const Segment& other) const noexcept -> bool
+        {
+            return deliverAt != other.deliverAt ? deliverAt > other.deliverAt : order > other.order;
+        }
+    };
+
+    struct Endpoint
+    {
+        std::uint32_t                         generation {0};
+        bool                                  inUse {false};
+        bool                                  peerClosed {false};
+        std::uint32_t                         peer {NO_ENDPOINT};
+        std::uint32_t                         peerGeneration {0};
+        std::uint16_t                         listenPort {0};
+        std::uint64_t                         nextSendSequence {0};
+        std::uint64_t                         nextReceiveSequence {0};
+        TimePoint                             linkFreeAt {0};
+        std::string                           inbox;
+        std::size_t                           inboxOffset {0};
+        std::map<std::uint64_t, Segment>      outOfOrder;
+    };
+
+    struct Listener
+    {
+        std::deque<std::pair<std::uint32_t, std::uint32_t>> backlog;
+    };
+
+    LinkConfig                                                                  m_config;
+    SimulatedClock                                                              m_clock;
+    std::mt19937_64                                                             m_random;
+    std::priority_queue<Segment, std::vector<Segment>, std::greater<>>           m_inFlight;
+    std::uint64_t                                                               m_order {0};
+    std::vector<Endpoint>                                                       m_endpoints;
+    std::vector<std::uint32_t>                                                  m_freeEndpoints;
+    std::unordered_map<std::uint16_t, Listener>                                 m_listeners;
+    Statistics                                                                  m_statistics {};
+
+    // Uniform in [0, 1), computed by hand because std::uniform_real_distribution differs between standard libraries.
+    auto random() noexcept -> double
+    {
+        static constexpr double SCALE {1.0 / static_cast<double>(std::uint64_t {1} << 53U)};
+        return static_cast<double>(m_random() >> 11U) * SCALE;
+    }
+
+    auto allocateEndpoint() -> std::uint32_t
+    {
+        std::uint32_t index {};
+        if (!m_freeEndpoints.empty())
+        {
+            index = m_freeEndpoints.back();
+            m_freeEndpoints.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(m_endpoints.size());
+            m_endpoints.emplace_back();
+        }
+        Endpoint&           endpoint   = m_endpoints[index];
+        const std::uint32_t GENERATION = endpoint.generation + 1;
+        endpoint                       = Endpoint {};
+        endpoint.generation            = GENERATION;
+        endpoint.inUse                 = true;
+        return index;
+    }
+
+    void releaseEndpoint(const std::uint32_t INDEX)
+    {
+        Endpoint& endpoint = m_endpoints[INDEX];
+        endpoint.inUse     = false;
+        endpoint.generation++;
+        endpoint.inbox.clear();
+        endpoint.inbox.shrink_to_fit();
+        endpoint.outOfOrder.clear();
+        m_freeEndpoints.push_back(INDEX);
+    }
+
+    [[nodiscard]]
+    auto getEndpoint(const std::uint32_t INDEX, const std::uint32_t GENERATION) noexcept -> Endpoint*
+    {
+        if (INDEX >= m_endpoints.size() || m_endpoints[INDEX].generation != GENERATION || !m_endpoints[INDEX].inUse)
+        {
+            return nullptr;
+        }
+        return &m_endpoints[INDEX];
+    }
+
+    // Puts one segment from endpoint source onto its outgoing link.
+    void transmit(Endpoint& source, const ESegmentType TYPE, std::string data)
+    {
+        TimePoint departure = std::max(m_clock.now(), source.linkFreeAt);
+        if (m_config.bandwidth > 0)
+        {
+            departure += Duration {
+              static_cast<std::int64_t>(data.size() * 1'000'000'000ULL / m_config.bandwidth)
+            };
+        }
+        source.linkFreeAt   = departure;
+
+        TimePoint deliverAt = departure + m_config.latency;
+        while (m_config.lossRate > 0.0 && random() < m_config.lossRate)
+        {
+            deliverAt += m_config.retransmitTimeout;
+            m_statistics.retransmissions++;
+        }
+        if (m_config.reorderRate > 0.0 && random() < m_config.reorderRate)
+        {
+            deliverAt += m_config.reorderDelay;
+            m_statistics.reordered++;
+        }
+
+        m_statistics.segments++;
+        m_statistics.bytes += data.size();
+        m_inFlight.push(Segment {
+          .deliverAt  = deliverAt,
+          .order      = m_order++,
+          .target     = source.peer,
+          .generation = source.peerGeneration,
+          .sequence   = source.nextSendSequence++,
+          .type       = TYPE,
+          .data       = std::move(data),
+        });
+    }
+
+    void apply(Endpoint& endpoint, Segment& segment)
+    {
+        if (segment.type == ESegmentType::FIN)
+        {
+            endpoint.peerClosed = true;
+            return;
+        }
+        if (endpoint.inboxOffset == endpoint.inbox.size())
+        {
+            endpoint.inbox.clear();
+            endpoint.inboxOffset = 0;
+        }
+        if (endpoint.inbox.empty())
+        {
+            endpoint.inbox = std::move(segment.data);
+        }
+        else
+        {
+            endpoint.inbox.append(segment.data);
+        }
+    }
+
+    void deliver(Segment& segment)
+    {
+        if (segment.type == ESegmentType::SYN)
+        {
+            // Target is the accepting endpoint, created together with the connecting one.
+            Endpoint* endpoint = getEndpoint(segment.target, segment.generation);
+            if (endpoint == nullptr)
+            {
+                m_statistics.dropped++;
+                return;
+            }
+            const auto LISTENER_IT = m_listeners.find(endpoint->listenPort);
+            if (LISTENER_IT == m_listeners.end())
+            {
+                // Nobody listens anymore, the connecting side sees the connection closed.
+                m_statistics.refused++;
+                if (Endpoint* peer = getEndpoint(endpoint->peer, endpoint->peerGeneration))
+                {
+                    peer->peerClosed = true;
+                }
+                releaseEndpoint(segment.target);
+                return;
+            }
+            LISTENER_IT->second.backlog.emplace_back(segment.target, segment.generation);
+            return;
+        }
+
+        Endpoint* endpoint = getEndpoint(segment.target, segment.generation);
+        if (endpoint == nullptr)
+        {
+            // The receiving end was closed while the segment was on its way.
+            m_statistics.dropped++;
+            return;
+        }
+        if (segment.sequence != endpoint->nextReceiveSequence)
+        {
+            const std::uint64_t SEQUENCE = segment.sequence;
+            endpoint->outOfOrder.emplace(SEQUENCE, std::move(segment));
+            return;
+        }
+        apply(*endpoint, segment);
+        endpoint->nextReceiveSequence++;
+        for (auto it = endpoint->outOfOrder.begin();
+             it != endpoint->outOfOrder.end() && it->first == endpoint->nextReceiveSequence;
+             it = endpoint->outOfOrder.erase(it))
+        {
+            apply(*endpoint, it->second);
+            endpoint->nextReceiveSequence++;
+        }
+    }
+
+    void closeEndpoint(const std::uint32_t INDEX, const std::uint32_t GENERATION)
+    {
+        Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        if (endpoint == nullptr)
+        {
+            return;
+        }
+        if (!endpoint->peerClosed)
+        {
+            transmit(*endpoint, ESegmentType::FIN, {});
+        }
+        releaseEndpoint(INDEX);
+    }
+
+    auto send(const std::uint32_t INDEX, const std::uint32_t GENERATION, const std::span<const std::string_view> parts)
+      -> std::int64_t
+    {
+        Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        if (endpoint == nullptr || endpoint->peerClosed)
+        {
+            return -1;
+        }
+
+        const std::size_t SEGMENT_SIZE = std::max<std::size_t>(m_config.maxSegmentSize, 1);
+        std::size_t       total {0};
+        std::string       segment {};
+        for (const std::string_view PART : parts)
+        {
+            for (std::size_t offset = 0; offset < PART.size();)
+            {
+                const std::size_t LENGTH = std::min(PART.size() - offset, SEGMENT_SIZE - segment.size());
+                segment.append(PART.substr(offset, LENGTH));
+                offset += LENGTH;
+                if (segment.size() == SEGMENT_SIZE)
+                {
+                    total += segment.size();
+                    transmit(*endpoint, ESegmentType::DATA, std::move(segment));
+                    segment = std::string {};
+                }
+            }
+        }
+        if (!segment.empty())
+        {
+            total += segment.size();
+            transmit(*endpoint, ESegmentType::DATA, std::move(segment));
+        }
+        return static_cast<std::int64_t>(total);
+    }
+
+    auto recvInto(const std::uint32_t INDEX, const std::uint32_t GENERATION, const std::span<char> buffer)
+      -> std::int64_t
+    {
+        Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        if (endpoint == nullptr)
+        {
+            return -1;
+        }
+        const std::size_t AVAILABLE = endpoint->inbox.size() - endpoint->inboxOffset;
+        if (AVAILABLE == 0)
+        {
+            return endpoint->peerClosed ? 0 : -1;
+        }
+        const std::size_t LENGTH = std::min(AVAILABLE, buffer.size());
+        std::copy_n(endpoint->inbox.data() + endpoint->inboxOffset, LENGTH, buffer.data());
+        endpoint->inboxOffset += LENGTH;
+        return static_cast<std::int64_t>(LENGTH);
+    }
+
+    auto recv(const std::uint32_t INDEX, const std::uint32_t GENERATION) -> std::optional<std::string>
+    {
+        Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        if (endpoint == nullptr || endpoint->inboxOffset == endpoint->inbox.size())
+        {
+            return std::nullopt;
+        }
+        std::string data {};
+        if (endpoint->inboxOffset == 0)
+        {
+            data.swap(endpoint->inbox);
+        }
+        else
+        {
+            data.assign(endpoint->inbox, endpoint->inboxOffset);
+            endpoint->inbox.clear();
+        }
+        endpoint->inboxOffset = 0;
+        return data;
+    }
+
+    [[nodiscard]]
+    auto getAvailable(const std::uint32_t INDEX, const std::uint32_t GENERATION) noexcept -> std::size_t
+    {
+        const Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        return endpoint == nullptr ? 0 : endpoint->inbox.size() - endpoint->inboxOffset;
+    }
+
+    [[nodiscard]]
+    auto isPeerClosed(const std::uint32_t INDEX, const std::uint32_t GENERATION) noexcept -> bool
+    {
+        const Endpoint* endpoint = getEndpoint(INDEX, GENERATION);
+        return endpoint == nullptr || endpoint->peerClosed;
+    }
+
+    auto accept(const Port& port) -> std::optional<SimulatedConnection>
+    {
+        const auto LISTENER_IT = m_listeners.find(static_cast<std::uint16_t>(port));
+        if (LISTENER_IT == m_listeners.end() || LISTENER_IT->second.backlog.empty())
+        {
+            return std::nullopt;
+        }
+        const auto [INDEX, GENERATION] = LISTENER_IT->second.backlog.front();
+        LISTENER_IT->second.backlog.pop_front();
+        return SimulatedConnection {this, INDEX, GENERATION};
+    }
+
+    void closeListener(const Port& port)
+    {
+        const auto LISTENER_IT = m_listeners.find(static_cast<std::uint16_t>(port));
+        if (LISTENER_IT == m_listeners.end())
+        {
+            return;
+        }
+        // Connections that were never accepted are closed, their peers see the connection closed.
+        for (const auto& [index, generation] : LISTENER_IT->second.backlog)
+        {
+            closeEndpoint(index, generation);
+        }
+        m_listeners.erase(LISTENER_IT);
+    }
+
+  public:
+    SimulatedNetwork() : SimulatedNetwork(LinkConfig {}) {}
+
+    explicit SimulatedNetwork(const LinkConfig& config) : m_config {config}, m_random {config.seed}
+    {
+        // Written to reject NaN as well. A loss rate of 1 would retransmit every segment forever.
+        if (!(config.lossRate >= 0.0 && config.lossRate < 1.0))
+        {
+            throw std::runtime_error(std::format("Invalid loss rate {}, must be in [0, 1)", config.lossRate));
+        }
+        if (!(config.reorderRate >= 0.0 && config.reorderRate <= 1.0))
+        {
+            throw std::runtime_error(std::format("Invalid reorder rate {}, must be in [0, 1]", config.reorderRate));
+        }
+    }
+
+    SimulatedNetwork(const SimulatedNetwork&)                     = delete;
+    auto operator= (const SimulatedNetwork&) -> SimulatedNetwork& = delete;
+    SimulatedNetwork(SimulatedNetwork&&)                          = delete;
+    auto operator= (SimulatedNetwork&&) -> SimulatedNetwork&      = delete;
+    ~SimulatedNetwork()                                           = default;
+
+    // Throws if the port is already in use, like binding a ListeningSocket would.
+    [[nodiscard]]
+    auto listen(const Port& port) -> SimulatedListener
+    {
+        if (!m_listeners.try_emplace(static_cast<std::uint16_t>(port)).second)
+        {
+            throw std::runtime_error(std::format("Simulated port {} is already in use", port.data()));
+        }
+        return SimulatedListener {this, port};
+    }
+
+    // The connection can be written to right away. The listener sees it after one link latency. Throws if nothing
+    // listens on the port, like connecting a TCPSocket would.
+    [[nodiscard]]
+    auto connect(const Port& port) -> SimulatedConnection
+    {
+        if (!m_listeners.contains(static_cast<std::uint16_t>(port)))
+        {
+            m_statistics.refused++;
+            throw std::runtime_error(std::format("Unable to connect to simulated port {}", port.data()));
+        }
+        const std::uint32_t CLIENT = allocateEndpoint();
+        const std::uint32_t SERVER = allocateEndpoint();
+        Endpoint&           client = m_endpoints[CLIENT];
+        Endpoint&           server = m_endpoints[SERVER];
+        client.peer                = SERVER;
+        client.peerGeneration      = server.generation;
+        server.peer                = CLIENT;
+        server.peerGeneration      = client.generation;
+        server.listenPort          = static_cast<std::uint16_t>(port);
+        m_statistics.connections++;
+
+        m_inFlight.push(Segment {
+          .deliverAt  = m_clock.now() + m_config.latency,
+          .order      = m_order++,
+          .target     = SERVER,
+          .generation = server.generation,
+          .sequence   = 0,
+          .type       = ESegmentType::SYN,
+          .data       = {},
+        });
+        return SimulatedConnection {this, CLIENT, client.generation};
+    }
+
+    // Moves the clock forward and delivers everything that arrives until then. Returns the number of segments.
+    auto advance(const Duration DURATION) -> std::size_t { return advanceTo(m_clock.now() + DURATION); }
+
+    auto advanceTo(const TimePoint TIME_POINT) -> std::size_t
+    {
+        std::size_t delivered {0};
+        while (!m_inFlight.empty() && m_inFlight.top().deliverAt <= TIME_POINT)
+        {
+            // priority_queue only hands out const references, the segment data is moved out anyway.
+            auto segment = std::move(const_cast<Segment&>(m_inFlight.top())); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+            m_inFlight.pop();
+            m_clock.advanceTo(segment.deliverAt);
+            deliver(segment);
+            delivered++;
+        }
+        m_clock.advanceTo(TIME_POINT);
+        return delivered;
+    }
+
+    // Jumps straight to the next arrival and delivers everything due at that moment. Returns false if nothing is
+    // in flight.
+    auto step() -> bool
+    {
+        if (m_inFlight.empty())
+        {
+            return false;
+        }
+        advanceTo(m_inFlight.top().deliverAt);
+        return true;
+    }
+
+    // Delivers until nothing is in flight anymore.
+    auto runUntilIdle() -> std::size_t
+    {
+        std::size_t delivered {0};
+        while (!m_inFlight.empty())
+        {
+            delivered += advanceTo(m_inFlight.top().deliverAt);
+        }
+        return delivered;
+    }
+
+    [[nodiscard]]
+    auto now() const noexcept -> TimePoint
+    {
+        return m_clock.now();
+    }
+
+    [[nodiscard]]
+    auto getInFlight() const noexcept -> std::size_t
+    {
+        return m_inFlight.size();
+    }
+
+    [[nodiscard]]
+    auto getStatistics() const noexcept -> Statistics
+    {
+        return m_statistics;
+    }
+
+    [[nodiscard]]
+    auto getConfig() const noexcept -> const LinkConfig&
+    {
+        return m_config;
+    }
+};
+
+inline void SimulatedConnection::close() noexcept
+{
+    if (m_network != nullptr)
+    {
+        try
+        {
+            m_network->closeEndpoint(m_index, m_generation);
+        }
+        catch (...)
+        {
+            // Out of memory for the FIN, the peer never sees the close. Closing must not throw from destructors.
+        }
+        m_network = nullptr;
+        m_status  = ESocketStatus::DISCONNECTED;
+    }
+}
+
+inline auto SimulatedConnection::send(const std::string_view data) noexcept -> std::int64_t
+{
+    const std::array<std::string_view, 1> PARTS {data};
+    return sendGathered(PARTS);
+}
+
+inline auto SimulatedConnection::sendGathered(const std::span<const std::string_view> parts) noexcept -> std::int64_t
+{
+    if (!isOpen())
+    {
+        return -1;
+    }
+    try
+    {
+        return m_network->send(m_index, m_generation, parts);
+    }
+    catch (...)
+    {
+        // Part of the data may already be on the link, the stream cannot be continued.
+        m_status = ESocketStatus::ERROR;
+        return -1;
+    }
+}
+
+inline auto SimulatedConnection::recvInto(const std::span<char> buffer) noexcept -> std::int64_t
+{
+    if (!isOpen())
+    {
+        return -1;
+    }
+    const std::int64_t BYTES_READ = m_network->recvInto(m_index, m_generation, buffer);
+    if (BYTES_READ == 0 && !buffer.empty())
+    {
+        m_status = ESocketStatus::DISCONNECTED;
+    }
+    return BYTES_READ;
+}
+
+inline auto SimulatedConnection::recv() noexcept -> std::optional<std::string>
+{
+    if (!isOpen())
+    {
+        return std::nullopt;
+    }
+    auto data = m_network->recv(m_index, m_generation);
+    if (!data.has_value() && m_network->isPeerClosed(m_index, m_generation))
+    {
+        m_status = ESocketStatus::DISCONNECTED;
+    }
+    return data;
+}
+
+inline auto SimulatedConnection::hasData() noexcept -> bool
+{
+    return isOpen()
+           && (m_network->getAvailable(m_index, m_generation) > 0 || m_network->isPeerClosed(m_index, m_generation));
+}
+
+inline auto SimulatedConnection::queryConnectionClosed() noexcept -> bool
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+    if (m_network->getAvailable(m_index, m_generation) == 0 && m_network->isPeerClosed(m_index, m_generation))
+    {
+        m_status = ESocketStatus::DISCONNECTED;
+        return true;
+    }
+    return false;
+}
+
+inline auto SimulatedListener::accept() -> std::optional<SimulatedConnection>
+{
+    if (m_network == nullptr)
+    {
+        return std::nullopt;
+    }
+    return m_network->accept(m_port);
+}
+
+inline void SimulatedListener::close() noexcept
+{
+    if (m_network != nullptr)
+    {
+        try
+        {
+            m_network->closeListener(m_port);
+        }
+        catch (...)
+        {
+            // Same as SimulatedConnection::close(), a missing FIN is all that is lost.
+        }
+        m_network = nullptr;
+    }
+}
+
+static_assert(StreamConnection<SimulatedConnection>);
+static_assert(StreamListener<SimulatedListener>);
+
+} // namespace CPPSockets
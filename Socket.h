@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <array>
 #include <cstdint>
@@ -174,6 +175,12 @@ class Socket
     }
     auto operator= (Socket&& other) noexcept -> Socket&
     {
+        if (this == &other)
+        {
+            return *this;
+        }
+        // The descriptor held so far would leak otherwise.
+        close();
         m_socketFD       = other.m_socketFD;
         m_port           = other.m_port;
         m_address        = std::move(other.m_address);
@@ -233,10 +240,17 @@ class Socket
         return m_status == ESocketStatus::ERROR;
     }
 
+    // The one definition of an open socket, also used for statuses cached outside the socket.
+    [[nodiscard]]
+    static constexpr auto isOpenStatus(const ESocketStatus STATUS) noexcept -> bool
+    {
+        return STATUS == ESocketStatus::CONNECTED || STATUS == ESocketStatus::LISTENING || STATUS == ESocketStatus::OK;
+    }
+
     [[nodiscard]]
     auto isOpen() const noexcept -> bool
     {
-        return m_status == ESocketStatus::CONNECTED || m_status == ESocketStatus::LISTENING;
+        return isOpenStatus(m_status);
     }
 
     [[nodiscard]]
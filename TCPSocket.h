@@ -3,27 +3,147 @@
 #include <algorithm>
 #include <array>
 #include <cerrno>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <fcntl.h>
+#include <format>
 #include <iterator>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <optional>
+#include <poll.h>
 #include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <utility>
+#include <vector>
 
 #include "NetAddress.h"
 #include "Socket.h"
 
+// Not exported by older libc headers.
+#ifndef SO_PREFER_BUSY_POLL
+    #define SO_PREFER_BUSY_POLL 69
+#endif
+
 namespace CPPSockets
 {
 
 class TCPSocket : public Socket
 {
+  public:
+    // Write coalescing settings, see enableCoalescing().
+    struct CoalescingConfig
+    {
+        // Buffered bytes at which send() flushes immediately.
+        std::size_t               maxBufferedBytes {static_cast<std::size_t>(16 * 1'024)};
+        // Maximum time the oldest buffered byte may wait before flushIfDue() sends it.
+        std::chrono::microseconds maxDelay {200};
+        // Disable Nagle while coalescing, the buffering already does its job and Nagle only adds latency.
+        bool                      noDelay {true};
+    };
+
+    // Settings for recvSpin().
+    struct SpinConfig
+    {
+        // How long to retry non-blocking reads before falling back to a blocking wait.
+        std::chrono::microseconds spinBudget {50};
+        // Timeout of the blocking wait, negative waits indefinitely.
+        std::chrono::milliseconds blockTimeout {-1};
+    };
+
+    // A hit is a spin-then-block wait satisfied while spinning, a miss one that had to block.
+    struct SpinStats
+    {
+        std::uint64_t hits {0};
+        std::uint64_t misses {0};
+    };
+
+  private:
+    static constexpr std::size_t          MAX_IOVECS_PER_CALL {64};
+
+    bool                                  m_coalescing {false};
+    CoalescingConfig                      m_coalescingConfig {};
+    std::vector<std::string>              m_pendingWrites;
+    std::size_t                           m_pendingBytes {0};
+    // Bytes of m_pendingWrites.front() that a previous partial write already sent.
+    std::size_t                           m_pendingOffset {0};
+    std::chrono::steady_clock::time_point m_oldestPending {};
+    // TCP_NODELAY as it was before enableCoalescing() turned it on, restored by disableCoalescing().
+    std::optional<bool>                   m_noDelayBeforeCoalescing;
+
+    SpinStats                             m_spinStats {};
+
+    void setTCPOption(const int OPTION, const bool ENABLE) const
+    {
+        const int VALUE = ENABLE ? 1 : 0;
+        if (setsockopt(getFD(), IPPROTO_TCP, OPTION, &VALUE, sizeof(VALUE)) == -1)
+        {
+            throw std::runtime_error("Failed to set TCP socket option");
+        }
+    }
+
+    [[nodiscard]]
+    auto getTCPOption(const int OPTION) const -> bool
+    {
+        int       value {};
+        socklen_t optionLen = sizeof(value);
+        if (getsockopt(getFD(), IPPROTO_TCP, OPTION, &value, &optionLen) == -1)
+        {
+            throw std::runtime_error("Failed to get TCP socket option");
+        }
+        return value != 0;
+    }
+
+    static void cpuRelax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Reads everything that is available right now without blocking.
+    // Returns the bytes read, 0 when the peer closed the connection or -1 when nothing was available or on error.
+    auto drainNonBlocking(std::string& out) noexcept -> std::int64_t
+    {
+        static constexpr std::size_t  BUFFER_SIZE {4'096};
+        std::array<char, BUFFER_SIZE> buffer {};
+        std::int64_t                  totalBytesRead {0};
+        while (true)
+        {
+            const std::int64_t BYTES_READ = ::recv(getFD(), buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (BYTES_READ > 0)
+            {
+                out.append(buffer.data(), static_cast<std::size_t>(BYTES_READ));
+                totalBytesRead += BYTES_READ;
+                if (static_cast<std::size_t>(BYTES_READ) < buffer.size())
+                {
+                    return totalBytesRead;
+                }
+                continue;
+            }
+            if (BYTES_READ == 0)
+            {
+                setStatus(ESocketStatus::DISCONNECTED);
+                return totalBytesRead;
+            }
+            [[unlikely]]
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                setStatus(ESocketStatus::ERROR);
+            }
+            return totalBytesRead > 0 ? totalBytesRead : -1;
+        }
+    }
+
   public:
     explicit TCPSocket(int socketFD) : Socket(socketFD)
     {
@@ -86,17 +206,361 @@ class TCPSocket : public Socket
         setStatus(ESocketStatus::CONNECTED);
     }
 
-    ~TCPSocket()                                    = default;
+    ~TCPSocket()
+    {
+        // Best effort, data that does not fit into the kernel buffer right now is lost.
+        if (isOpen() && m_pendingBytes > 0)
+        {
+            flush();
+        }
+    }
+
     TCPSocket(const TCPSocket&)                     = delete;
     auto operator= (const TCPSocket&) -> TCPSocket& = delete;
-    TCPSocket(TCPSocket&& other) noexcept : Socket(std::move(other)) {}
+    TCPSocket(TCPSocket&& other) noexcept
+            : Socket(std::move(other)),
+              m_coalescing {other.m_coalescing},
+              m_coalescingConfig {other.m_coalescingConfig},
+              m_pendingWrites {std::move(other.m_pendingWrites)},
+              m_pendingBytes {other.m_pendingBytes},
+              m_pendingOffset {other.m_pendingOffset},
+              m_oldestPending {other.m_oldestPending},
+              m_noDelayBeforeCoalescing {other.m_noDelayBeforeCoalescing},
+              m_spinStats {other.m_spinStats}
+    {
+        other.m_pendingWrites.clear();
+        other.m_pendingBytes  = 0;
+        other.m_pendingOffset = 0;
+    }
     auto operator= (TCPSocket&& other) noexcept -> TCPSocket&
     {
         Socket::operator= (std::move(other));
+        m_coalescing              = other.m_coalescing;
+        m_coalescingConfig        = other.m_coalescingConfig;
+        m_pendingWrites           = std::move(other.m_pendingWrites);
+        m_pendingBytes            = other.m_pendingBytes;
+        m_pendingOffset           = other.m_pendingOffset;
+        m_oldestPending           = other.m_oldestPending;
+        m_noDelayBeforeCoalescing = other.m_noDelayBeforeCoalescing;
+        m_spinStats               = other.m_spinStats;
+        other.m_pendingWrites.clear();
+        other.m_pendingBytes      = 0;
+        other.m_pendingOffset     = 0;
         return *this;
     }
 
+    // Opt in to userspace write coalescing.
+    // send() then only buffers small writes, which go out together as one gathered write when flush() is called
+    // (typically at the end of an event loop iteration), when maxBufferedBytes is reached, or from flushIfDue()
+    // once the oldest buffered write is older than maxDelay.
+    void enableCoalescing() { enableCoalescing(CoalescingConfig {}); }
+
+    void enableCoalescing(const CoalescingConfig& config)
+    {
+        m_coalescingConfig = config;
+        m_coalescing       = true;
+        if (config.noDelay)
+        {
+            if (!m_noDelayBeforeCoalescing.has_value())
+            {
+                m_noDelayBeforeCoalescing = getTCPOption(TCP_NODELAY);
+            }
+            setTCPOption(TCP_NODELAY, true);
+        }
+    }
+
+    // Flushes what is buffered and returns to one syscall per send(), with Nagle set as it was before coalescing.
+    void disableCoalescing()
+    {
+        flush();
+        m_coalescing = false;
+        if (m_noDelayBeforeCoalescing.has_value())
+        {
+            setTCPOption(TCP_NODELAY, *m_noDelayBeforeCoalescing);
+            m_noDelayBeforeCoalescing.reset();
+        }
+    }
+
+    [[nodiscard]]
+    auto isCoalescing() const noexcept -> bool
+    {
+        return m_coalescing;
+    }
+
+    [[nodiscard]]
+    auto getPendingBytes() const noexcept -> std::size_t
+    {
+        return m_pendingBytes;
+    }
+
+    // Holds back partial segments until uncorked. Useful around a burst of writes that bypass coalescing.
+    void setCorked(const bool CORKED) const { setTCPOption(TCP_CORK, CORKED); }
+
+    // Writes out as much buffered data as the socket accepts, using as few gathered writes as possible.
+    // Returns the number of bytes written or -1 on error. On a non-blocking socket whatever does not fit stays
+    // buffered for the next flush.
+    auto flush() noexcept -> std::int64_t
+    {
+        std::int64_t totalBytesSent {};
+        while (m_pendingBytes > 0)
+        {
+            std::array<iovec, MAX_IOVECS_PER_CALL> iov {};
+            std::size_t                            iovCount {};
+            std::size_t                            batchBytes {};
+            for (; iovCount < iov.size() && iovCount < m_pendingWrites.size(); ++iovCount)
+            {
+                std::string&      chunk  = m_pendingWrites[iovCount];
+                const std::size_t OFFSET = iovCount == 0 ? m_pendingOffset : 0;
+                iov.at(iovCount)         = iovec {.iov_base = chunk.data() + OFFSET, .iov_len = chunk.size() - OFFSET};
+                batchBytes += chunk.size() - OFFSET;
+            }
+
+            msghdr message {};
+            message.msg_iov    = iov.data();
+            message.msg_iovlen = iovCount;
+            // Tell the kernel more is coming if this batch does not drain the buffer, so it does not push a
+            // partial segment in between.
+            const int          FLAGS      = batchBytes < m_pendingBytes ? MSG_MORE : 0;
+            const std::int64_t BYTES_SENT = ::sendmsg(getFD(), &message, FLAGS);
+
+            if (BYTES_SENT == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                setStatus(errno == EPIPE ? ESocketStatus::DISCONNECTED : ESocketStatus::ERROR);
+                return -1;
+            }
+
+            totalBytesSent    += BYTES_SENT;
+            m_pendingBytes    -= static_cast<std::size_t>(BYTES_SENT);
+            auto        remaining = static_cast<std::size_t>(BYTES_SENT);
+            std::size_t consumed {};
+            while (consumed < m_pendingWrites.size()
+                   && remaining >= m_pendingWrites[consumed].size() - m_pendingOffset)
+            {
+                remaining       -= m_pendingWrites[consumed].size() - m_pendingOffset;
+                m_pendingOffset  = 0;
+                ++consumed;
+            }
+            m_pendingWrites.erase(
+              m_pendingWrites.begin(), m_pendingWrites.begin() + static_cast<std::ptrdiff_t>(consumed)
+            );
+            m_pendingOffset += remaining;
+
+            if (static_cast<std::size_t>(BYTES_SENT) < batchBytes)
+            {
+                // Socket buffer is full, retrying right away would only spin.
+                break;
+            }
+        }
+        if (m_pendingBytes > 0)
+        {
+            // What is left was accepted by send() earlier, restart the latency bound from now on.
+            m_oldestPending = std::chrono::steady_clock::now();
+        }
+        return totalBytesSent;
+    }
+
+    // Flushes if the oldest buffered write has waited longer than the configured maxDelay.
+    auto flushIfDue() noexcept -> std::int64_t
+    {
+        if (m_pendingBytes == 0
+            || std::chrono::steady_clock::now() - m_oldestPending < m_coalescingConfig.maxDelay)
+        {
+            return 0;
+        }
+        return flush();
+    }
+
     auto send(const std::string& data) noexcept -> std::int64_t
+    {
+        if (m_coalescing)
+        {
+            return sendCoalesced(data);
+        }
+        if (m_pendingBytes > 0)
+        {
+            // Data left over from an earlier partial write must go out first. Without coalescing nothing else
+            // flushes it, sendGathered() writes it out and queues behind what does not fit.
+            const std::array<std::string_view, 1> PARTS {data};
+            return sendGathered(PARTS);
+        }
+        return sendDirect(data);
+    }
+
+    // Sends all parts as one gathered write without concatenating them first.
+    // If the socket does not take everything (non-blocking socket with a full send buffer), the rest is copied
+    // into the pending buffer and goes out with the next flush(). Returns the number of bytes accepted or -1.
+    auto sendGathered(const std::span<const std::string_view> parts) noexcept -> std::int64_t
+    {
+        std::size_t totalBytes {};
+        for (const auto& part : parts)
+        {
+            totalBytes += part.size();
+        }
+
+        const bool COALESCE = m_coalescing && totalBytes < m_coalescingConfig.maxBufferedBytes;
+        if (!COALESCE && m_pendingBytes > 0 && flush() == -1)
+        {
+            return -1;
+        }
+
+        if (COALESCE || m_pendingBytes > 0)
+        {
+            if (!queuePending(parts, 0, 0))
+            {
+                return -1;
+            }
+            if ((!m_coalescing || m_pendingBytes >= m_coalescingConfig.maxBufferedBytes) && flush() == -1)
+            {
+                return -1;
+            }
+            return static_cast<std::int64_t>(totalBytes);
+        }
+
+        std::size_t partIndex {};
+        std::size_t partOffset {};
+        while (partIndex < parts.size())
+        {
+            std::array<iovec, MAX_IOVECS_PER_CALL> iov {};
+            std::size_t                            iovCount {};
+            for (std::size_t i = partIndex; i < parts.size() && iovCount < iov.size(); ++i)
+            {
+                const std::size_t OFFSET = i == partIndex ? partOffset : 0;
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast) // iovec is shared by readv and writev.
+                iov.at(iovCount++) = iovec {.iov_base = const_cast<char*>(parts[i].data()) + OFFSET,
+                                            .iov_len  = parts[i].size() - OFFSET};
+            }
+
+            msghdr message {};
+            message.msg_iov    = iov.data();
+            message.msg_iovlen = iovCount;
+            const std::int64_t BYTES_SENT = ::sendmsg(getFD(), &message, 0);
+            if (BYTES_SENT == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    if (!queuePending(parts, partIndex, partOffset))
+                    {
+                        return -1;
+                    }
+                    return static_cast<std::int64_t>(totalBytes);
+                }
+                setStatus(errno == EPIPE ? ESocketStatus::DISCONNECTED : ESocketStatus::ERROR);
+                return -1;
+            }
+
+            auto remaining = static_cast<std::size_t>(BYTES_SENT);
+            while (partIndex < parts.size() && remaining >= parts[partIndex].size() - partOffset)
+            {
+                remaining  -= parts[partIndex].size() - partOffset;
+                partOffset  = 0;
+                ++partIndex;
+            }
+            partOffset += remaining;
+        }
+        return static_cast<std::int64_t>(totalBytes);
+    }
+
+    // Reads whatever is available (or blocks for it on a blocking socket) directly into the caller's buffer.
+    // Returns the number of bytes read, 0 if the peer closed the connection or -1 if nothing was read.
+    auto recvInto(const std::span<char> buffer) noexcept -> std::int64_t
+    {
+        const std::int64_t BYTES_READ = ::recv(getFD(), buffer.data(), buffer.size(), 0);
+        if (BYTES_READ == 0 && !buffer.empty())
+        {
+            setStatus(ESocketStatus::DISCONNECTED);
+        }
+        else if (BYTES_READ == -1)
+        {
+            [[unlikely]]
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                setStatus(ESocketStatus::ERROR);
+            }
+        }
+        return BYTES_READ;
+    }
+
+  private:
+    // Copies parts, starting at FIRST_PART skipping its first FIRST_OFFSET bytes, into the pending buffer.
+    auto queuePending(
+      const std::span<const std::string_view> parts,
+      const std::size_t                       FIRST_PART,
+      const std::size_t                       FIRST_OFFSET
+    ) noexcept -> bool
+    {
+        try
+        {
+            if (m_pendingBytes == 0)
+            {
+                m_oldestPending = std::chrono::steady_clock::now();
+            }
+            for (std::size_t i = FIRST_PART; i < parts.size(); ++i)
+            {
+                const auto PART = parts[i].substr(i == FIRST_PART ? FIRST_OFFSET : 0);
+                if (PART.empty())
+                {
+                    continue;
+                }
+                // Pack small writes together, fewer allocations and fewer iovecs on flush.
+                if (!m_pendingWrites.empty()
+                    && m_pendingWrites.back().size() + PART.size() <= m_coalescingConfig.maxBufferedBytes)
+                {
+                    m_pendingWrites.back().append(PART);
+                }
+                else
+                {
+                    m_pendingWrites.emplace_back(PART);
+                }
+                m_pendingBytes += PART.size();
+            }
+        }
+        catch (...)
+        {
+            setStatus(ESocketStatus::ERROR);
+            return false;
+        }
+        return true;
+    }
+
+    auto sendCoalesced(const std::string& data) noexcept -> std::int64_t
+    {
+        if (data.empty())
+        {
+            return 0;
+        }
+
+        const std::array<std::string_view, 1> PARTS {data};
+        if (m_pendingBytes == 0 && data.size() >= m_coalescingConfig.maxBufferedBytes)
+        {
+            // Too large to be worth copying, but whatever the socket does not take is still queued like every other
+            // write in coalescing mode, so the data is either fully accepted or the call fails.
+            return sendGathered(PARTS);
+        }
+
+        if (!queuePending(PARTS, 0, 0))
+        {
+            return -1;
+        }
+
+        if (m_pendingBytes >= m_coalescingConfig.maxBufferedBytes || m_pendingWrites.size() >= MAX_IOVECS_PER_CALL)
+        {
+            if (flush() == -1)
+            {
+                return -1;
+            }
+        }
+        else if (flushIfDue() == -1)
+        {
+            return -1;
+        }
+        return static_cast<std::int64_t>(data.size());
+    }
+
+    auto sendDirect(const std::string& data) noexcept -> std::int64_t
     {
         const std::int64_t BYTES_SENT = ::send(getFD(), data.c_str(), data.size(), 0);
 
@@ -143,6 +607,7 @@ class TCPSocket : public Socket
         return BYTES_SENT;
     }
 
+  public:
     [[nodiscard]]
     auto queryConnectionClosed() noexcept -> bool
     {
@@ -223,6 +688,85 @@ class TCPSocket : public Socket
         }
         return ss.str();
     }
+
+    // Low latency receive. Spins on non-blocking reads for the configured budget and only then blocks in poll(),
+    // trading CPU time for the scheduler wakeup latency of a blocking read. Works regardless of the blocking mode.
+    // Pair it with setBusyPoll() and pinCurrentThread() from ThreadAffinity.h on dedicated cores.
+    [[nodiscard]]
+    auto recvSpin() noexcept -> std::optional<std::string>
+    {
+        return recvSpin(SpinConfig {});
+    }
+
+    [[nodiscard]]
+    auto recvSpin(const SpinConfig& config) noexcept -> std::optional<std::string>
+    {
+        std::string data {};
+        const auto  DEADLINE = std::chrono::steady_clock::now() + config.spinBudget;
+        do
+        {
+            const std::int64_t BYTES_READ = drainNonBlocking(data);
+            if (BYTES_READ >= 0)
+            {
+                m_spinStats.hits++;
+                return data.empty() ? std::nullopt : std::optional<std::string> {std::move(data)};
+            }
+            if (isError())
+            {
+                return std::nullopt;
+            }
+            cpuRelax();
+        } while (std::chrono::steady_clock::now() < DEADLINE);
+
+        m_spinStats.misses++;
+
+        pollfd    pfd {.fd = getFD(), .events = POLLIN, .revents = 0};
+        const int READY = ::poll(&pfd, 1, static_cast<int>(config.blockTimeout.count()));
+        [[unlikely]]
+        if (READY == -1 && errno != EINTR)
+        {
+            setStatus(ESocketStatus::ERROR);
+            return std::nullopt;
+        }
+        if (READY <= 0)
+        {
+            return std::nullopt;
+        }
+
+        drainNonBlocking(data);
+        return data.empty() ? std::nullopt : std::optional<std::string> {std::move(data)};
+    }
+
+    [[nodiscard]]
+    auto getSpinStats() const noexcept -> SpinStats
+    {
+        return m_spinStats;
+    }
+
+    void resetSpinStats() noexcept { m_spinStats = SpinStats {}; }
+
+    // Lets the kernel busy poll the device queue for up to BUSY_POLL_TIME on blocking reads (SO_BUSY_POLL), and
+    // optionally prefer busy polling over interrupt driven processing (SO_PREFER_BUSY_POLL, Linux 5.11+).
+    // Raising the value above net.core.busy_read requires CAP_NET_ADMIN.
+    void setBusyPoll(const std::chrono::microseconds BUSY_POLL_TIME, const bool PREFER_BUSY_POLL = false) const
+    {
+        const int BUSY_POLL_USEC = static_cast<int>(BUSY_POLL_TIME.count());
+        if (setsockopt(getFD(), SOL_SOCKET, SO_BUSY_POLL, &BUSY_POLL_USEC, sizeof(BUSY_POLL_USEC)) == -1)
+        {
+            throw std::runtime_error("Failed to set socket option SO_BUSY_POLL");
+        }
+
+        // Only touched when asked for, older kernels reject the option with ENOPROTOOPT.
+        if (!PREFER_BUSY_POLL)
+        {
+            return;
+        }
+        const int PREFER = 1;
+        if (setsockopt(getFD(), SOL_SOCKET, SO_PREFER_BUSY_POLL, &PREFER, sizeof(PREFER)) == -1)
+        {
+            throw std::runtime_error("Failed to set socket option SO_PREFER_BUSY_POLL");
+        }
+    }
 };
 
 } // namespace CPPSockets
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <format>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+
+namespace CPPSockets
+{
+
+// Pins the calling thread to a single CPU, so that a spinning receive loop keeps its core and its caches.
+inline void pinCurrentThread(const int CPU)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(CPU, &cpuSet);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        throw std::runtime_error(std::format("Unable to pin thread to CPU {}", CPU));
+    }
+}
+
+} // namespace CPPSockets
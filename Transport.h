@@ -0,0 +1,45 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "ListeningSocket.h"
+#include "TCPSocket.h"
+
+namespace CPPSockets
+{
+
+// What the protocol layers (HTTPSession and friends) need from a byte stream. TCPSocket is the real implementation,
+// SimulatedConnection from SimulatedNetwork.h an in-process one for deterministic tests and overhead benchmarks.
+// Return values follow TCPSocket: byte counts, 0 from a read means the peer closed, -1 means nothing was done.
+template <typename T>
+concept StreamConnection = std::movable<T> && requires(
+  T& connection, const std::string& data, std::span<const std::string_view> parts, std::span<char> buffer
+) {
+    { connection.send(data) } -> std::same_as<std::int64_t>;
+    { connection.sendGathered(parts) } -> std::same_as<std::int64_t>;
+    { connection.recvInto(buffer) } -> std::same_as<std::int64_t>;
+    { connection.recv() } -> std::same_as<std::optional<std::string>>;
+    { connection.flush() } -> std::same_as<std::int64_t>;
+    { connection.getPendingBytes() } -> std::same_as<std::size_t>;
+    { connection.hasData() } -> std::same_as<bool>;
+    { connection.queryConnectionClosed() } -> std::same_as<bool>;
+    { connection.isOpen() } -> std::same_as<bool>;
+    { connection.isBlocking() } -> std::same_as<bool>;
+    connection.close();
+};
+
+template <typename T>
+concept StreamListener = requires(T& listener) {
+    listener.accept();
+    requires StreamConnection<typename decltype(listener.accept())::value_type>;
+};
+
+static_assert(StreamConnection<TCPSocket>);
+static_assert(StreamListener<ListeningSocket>);
+
+} // namespace CPPSockets
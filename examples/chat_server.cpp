@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 
+#include "../ConnectionTable.h"
 #include "../ListeningSocket.h"
 
 // NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
@@ -12,7 +13,7 @@ auto main() -> int
     const NetAddress         BINDADDR("0.0.0.0");
     const Port               BINDPORT(4'444);
 
-    std::vector<TCPSocket>   clients {};
+    ConnectionTable<>        clients {};
     std::vector<std::string> messageQueue;
 
     auto                     sock = ListeningSocket(BINDADDR, BINDPORT, false);
@@ -24,21 +25,21 @@ auto main() -> int
         {
             std::cout << *newClient << " connected.\n";
             newClient->setBlocking(false);
+            newClient->enableCoalescing();
             newClient->send("Welcome to the chat.\n");
             messageQueue.push_back(
               std::format("{}:{} has joined.\n", newClient->getAddress().data(), newClient->getPort().data())
             );
-            clients.push_back(std::move(*newClient));
+            clients.insert(std::move(*newClient));
         }
-        for (auto& client : clients)
-        {
+        clients.forEach([&messageQueue](ConnectionHandle /*handle*/, TCPSocket& client, std::monostate& /*data*/) {
             if (client.queryConnectionClosed())
             {
                 std::cout << client << " disconnected.\n";
                 messageQueue.push_back(
                   std::format("{}:{} has left.\n", client.getAddress().data(), client.getPort().data())
                 );
-                continue;
+                return;
             }
             auto msg = client.recv();
             if (msg.has_value())
@@ -48,11 +49,11 @@ auto main() -> int
                   std::format("[ {}:{} ]: {}\n", client.getAddress().data(), client.getPort().data(), *msg)
                 );
             }
-        }
+        });
 
-        std::erase_if(clients, [](TCPSocket& client) { return !client.isOpen(); });
+        clients.eraseClosed();
 
-        for (auto& client : clients)
+        for (auto& client : clients.sockets())
         {
             for (auto& msg : messageQueue)
             {
@@ -65,5 +66,6 @@ auto main() -> int
         }
 
         messageQueue.clear();
+        clients.flushAll();
     }
 }
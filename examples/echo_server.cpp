@@ -0,0 +1,64 @@
+// Sends everything back to the client it came from. Target for tools/load_generator.cpp in echo mode.
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "../ConnectionTable.h"
+#include "../ListeningSocket.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+auto main() -> int
+{
+    const NetAddress              BINDADDR("0.0.0.0");
+    const Port                    BINDPORT(4'450);
+
+    ConnectionTable<>             clients {};
+    std::vector<ConnectionHandle> ready {};
+    std::array<char, 64 * 1'024>  buffer {};
+
+    auto                          sock = ListeningSocket(BINDADDR, BINDPORT, false);
+
+    // New connections wake the wait through the listener. The timeout only bounds how long writes the kernel did not
+    // take stay in the coalescing buffers before flushAll() retries them.
+    const TCPSocket::SpinConfig   WAIT_CONFIG {.spinBudget = std::chrono::microseconds {0}, .blockTimeout = std::chrono::milliseconds {10}};
+
+    while (true)
+    {
+        bool listenerReadable {false};
+        clients.waitReadable(ready, WAIT_CONFIG, sock, listenerReadable);
+        while (listenerReadable)
+        {
+            auto newClient = sock.accept();
+            if (!newClient.has_value())
+            {
+                break;
+            }
+            newClient->setBlocking(false);
+            // Whatever the kernel does not take right away waits in the coalescing buffer instead of being lost.
+            newClient->enableCoalescing();
+            clients.insert(std::move(*newClient));
+        }
+
+        for (const auto& handle : ready)
+        {
+            TCPSocket& client = *clients.getSocket(handle);
+            while (client.isOpen())
+            {
+                const std::int64_t BYTES_READ = client.recvInto(buffer);
+                if (BYTES_READ <= 0)
+                {
+                    break;
+                }
+                const std::array<std::string_view, 1> PARTS {std::string_view {buffer.data(), static_cast<std::size_t>(BYTES_READ)}};
+                client.sendGathered(PARTS);
+            }
+        }
+
+        clients.flushAll();
+        clients.eraseClosed();
+    }
+}
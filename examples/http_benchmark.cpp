@@ -0,0 +1,114 @@
+// Compares HTTP request throughput of HTTPSession against raw echo throughput of the same TCPSocket on loopback.
+// Both phases use the same pipeline depth and payload size, so the difference is the cost of HTTP parsing and
+// response serialization.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../HTTP.h"
+#include "../ListeningSocket.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+constexpr std::size_t   PIPELINE_DEPTH {32};
+constexpr std::size_t   ROUNDS {20'000};
+constexpr std::uint16_t RAW_PORT {4'445};
+constexpr std::uint16_t HTTP_PORT {4'446};
+
+// Sends PIPELINE_DEPTH copies of REQUEST per round and waits for PIPELINE_DEPTH * RESPONSE_SIZE bytes.
+void runClient(const Port& port, const std::string& request, const std::size_t RESPONSE_SIZE, const std::string& name)
+{
+    TCPSocket   client(NetAddress("127.0.0.1"), port, true);
+
+    std::string batch {};
+    for (std::size_t i = 0; i < PIPELINE_DEPTH; ++i)
+    {
+        batch += request;
+    }
+    std::vector<char> buffer(PIPELINE_DEPTH * RESPONSE_SIZE);
+
+    const auto        START = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < ROUNDS; ++round)
+    {
+        client.send(batch);
+        std::size_t received {};
+        while (received < buffer.size())
+        {
+            const std::int64_t BYTES_READ = client.recvInto(std::span<char> {buffer}.subspan(received));
+            if (BYTES_READ <= 0)
+            {
+                std::cerr << name << ": connection lost\n";
+                return;
+            }
+            received += static_cast<std::size_t>(BYTES_READ);
+        }
+    }
+    const std::chrono::duration<double> ELAPSED  = std::chrono::steady_clock::now() - START;
+
+    const double                        MESSAGES = static_cast<double>(ROUNDS * PIPELINE_DEPTH);
+    std::cout << name << ": " << static_cast<std::uint64_t>(MESSAGES / ELAPSED.count()) << " msg/s, "
+              << (MESSAGES * static_cast<double>(request.size() + RESPONSE_SIZE)) / ELAPSED.count() / 1e6
+              << " MB/s\n";
+}
+
+void runRawServer(ListeningSocket& listener)
+{
+    auto              client = *listener.accept();
+    std::vector<char> buffer(HTTPSession::DEFAULT_BUFFER_SIZE);
+    while (client.isOpen())
+    {
+        const std::int64_t BYTES_READ = client.recvInto(buffer);
+        if (BYTES_READ <= 0)
+        {
+            break;
+        }
+        const std::array<std::string_view, 1> PARTS {std::string_view {buffer.data(), static_cast<std::size_t>(BYTES_READ)}};
+        client.sendGathered(PARTS);
+    }
+}
+
+void runHTTPServer(ListeningSocket& listener, const std::string& body)
+{
+    auto        client = *listener.accept();
+    HTTPSession session {};
+    while (session.process(client, [&body](const HTTPRequest& /*request*/, HTTPResponse& response) { response.setBody(std::string_view {body}); }))
+    {}
+}
+
+} // namespace
+
+auto main() -> int
+{
+    static constexpr std::size_t PAYLOAD_SIZE {64};
+    const std::string            PAYLOAD(PAYLOAD_SIZE, 'x');
+
+    {
+        ListeningSocket listener(NetAddress("127.0.0.1"), Port(RAW_PORT), true);
+        std::thread     server(runRawServer, std::ref(listener));
+        runClient(Port(RAW_PORT), PAYLOAD, PAYLOAD_SIZE, "raw  echo");
+        server.join();
+    }
+
+    {
+        const std::string REQUEST = "GET /bench HTTP/1.1\r\nHost: localhost\r\nUser-Agent: http_benchmark\r\n\r\n";
+        HTTPResponse      response {};
+        response.setBody(std::string_view {PAYLOAD});
+        std::string head {};
+        response.serializeHead(head);
+
+        ListeningSocket listener(NetAddress("127.0.0.1"), Port(HTTP_PORT), true);
+        std::thread     server(runHTTPServer, std::ref(listener), std::cref(PAYLOAD));
+        runClient(Port(HTTP_PORT), REQUEST, head.size() + PAYLOAD_SIZE, "http     ");
+        server.join();
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../ConnectionTable.h"
+#include "../HTTP.h"
+#include "../ListeningSocket.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+auto main() -> int
+{
+    const NetAddress                BINDADDR("0.0.0.0");
+    const Port                      BINDPORT(8'080);
+
+    ConnectionTable<HTTPSession>    clients {};
+    std::vector<ConnectionHandle>   ready {};
+
+    auto                            sock = ListeningSocket(BINDADDR, BINDPORT, false);
+
+    // New connections wake the wait through the listener. The timeout only bounds how long writes the kernel did not
+    // take stay in the coalescing buffers before flushAll() retries them.
+    const TCPSocket::SpinConfig     WAIT_CONFIG {.spinBudget = std::chrono::microseconds {0}, .blockTimeout = std::chrono::milliseconds {10}};
+
+    const auto                      HANDLER = [](const HTTPRequest& request, HTTPResponse& response)
+    {
+        if (request.getTarget() == "/")
+        {
+            response.addHeader("Content-Type", "text/plain");
+            response.setBody(std::string_view {"Hello from cppsockets.\n"});
+        }
+        else if (request.getTarget() == "/echo")
+        {
+            // The request body lives in the session buffer, which stays untouched until the response was sent.
+            response.setBody(request.getBody());
+        }
+        else
+        {
+            response.setStatus(404);
+        }
+    };
+
+    while (true)
+    {
+        bool listenerReadable {false};
+        clients.waitReadable(ready, WAIT_CONFIG, sock, listenerReadable);
+        while (listenerReadable)
+        {
+            auto newClient = sock.accept();
+            if (!newClient.has_value())
+            {
+                break;
+            }
+            newClient->setBlocking(false);
+            clients.insert(std::move(*newClient));
+        }
+
+        for (const auto& handle : ready)
+        {
+            clients.getUserData(handle)->process(*clients.getSocket(handle), HANDLER);
+        }
+
+        clients.flushAll();
+        clients.eraseClosed();
+    }
+}
@@ -0,0 +1,101 @@
+// Runs many concurrent calls, one of them large, over a single multiplexed connection and prints the
+// head of line blocking metrics of both sides.
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <future>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../ListeningSocket.h"
+#include "../MultiplexedConnection.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+void printMetrics(const std::string& name, const MultiplexedConnection::Metrics& metrics)
+{
+    std::cout << name << ": frames sent " << metrics.framesSent << ", received " << metrics.framesReceived
+              << ", messages " << metrics.messagesSent << ", avg queue delay "
+              << (metrics.messagesSent == 0 ? 0 : metrics.totalQueueDelay.count() / static_cast<std::int64_t>(metrics.messagesSent))
+              << "us, max " << metrics.maxQueueDelay.count() << "us, flow control stalls " << metrics.flowControlStalls
+              << ", socket stalls " << metrics.socketStalls << '\n';
+}
+
+} // namespace
+
+auto main() -> int
+{
+    static constexpr std::size_t CALLS {1'000};
+    static constexpr std::size_t LARGE_CALL_SIZE {static_cast<std::size_t>(8 * 1'024 * 1'024)};
+    const Port                   PORT {4'447};
+
+    ListeningSocket              listener(NetAddress("127.0.0.1"), PORT, true);
+    std::atomic<bool>            done {false};
+
+    std::thread                  serverThread(
+      [&listener, &done]()
+      {
+          MultiplexedConnection server(
+            std::move(*listener.accept()), MultiplexedConnection::ERole::SERVER, MultiplexedConnection::Config {.maxConcurrentStreams = CALLS + 1}
+          );
+          // Answers chunk by chunk, a request handler would only take requests up to the flow control window.
+          server.setStreamHandler(
+            [&server](MultiplexedConnection::StreamID id, std::string_view data, bool endStream)
+            {
+                std::string response(data.size(), '\0');
+                std::ranges::transform(data, response.begin(), [](unsigned char chr) { return static_cast<char>(std::toupper(chr)); });
+                server.send(id, response, endStream);
+            }
+          );
+          while (server.pump(std::chrono::milliseconds {10}) && !done)
+          {}
+          printMetrics("server", server.getMetrics());
+      }
+    );
+
+    MultiplexedConnection client(TCPSocket(NetAddress("127.0.0.1"), PORT, true), MultiplexedConnection::ERole::CLIENT);
+    std::thread           clientIO(
+      [&client, &done]()
+      {
+          while (client.pump(std::chrono::milliseconds {10}) && !done)
+          {}
+      }
+    );
+
+    const auto                            START = std::chrono::steady_clock::now();
+    std::future<std::string>              large = client.call(std::string(LARGE_CALL_SIZE, 'x'));
+    std::vector<std::future<std::string>> small {};
+    small.reserve(CALLS);
+    for (std::size_t i = 0; i < CALLS; ++i)
+    {
+        small.push_back(client.call("call " + std::to_string(i)));
+    }
+
+    bool ok = true;
+    for (std::size_t i = 0; i < CALLS; ++i)
+    {
+        ok = ok && small[i].get() == "CALL " + std::to_string(i);
+    }
+    const auto SMALL_DONE = std::chrono::steady_clock::now();
+    ok                    = ok && large.get() == std::string(LARGE_CALL_SIZE, 'X');
+    const auto LARGE_DONE = std::chrono::steady_clock::now();
+
+    std::cout << (ok ? "all responses correct" : "WRONG RESPONSE") << ", small calls done after "
+              << std::chrono::duration_cast<std::chrono::microseconds>(SMALL_DONE - START).count()
+              << "us, large call after "
+              << std::chrono::duration_cast<std::chrono::microseconds>(LARGE_DONE - START).count() << "us\n";
+
+    done = true;
+    clientIO.join();
+    printMetrics("client", client.getMetrics());
+    serverThread.join();
+
+    return ok ? 0 : 1;
+}
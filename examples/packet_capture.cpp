@@ -0,0 +1,137 @@
+// Captures UDP datagrams to port 4449 on the loopback interface through a PacketSocket with a BPF filter, once
+// sent through a regular UDP socket and once injected as raw Ethernet frames through the TX ring.
+// Needs CAP_NET_RAW, e.g. run as root.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <netinet/in.h>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../PacketSocket.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+constexpr std::uint16_t UDP_PORT {4'449};
+constexpr std::size_t   DATAGRAMS {1'000};
+
+// tcpdump -dd "ip and udp dst port 4449", for frames with a 14 byte Ethernet header and no IP options.
+const std::array<sock_filter, 8> FILTER {
+  {
+   {0x28, 0, 0, 0x0000000c},  // ldh [12]             ethertype
+   {0x15, 0, 5, 0x00000800},  // jeq #0x800           IPv4
+   {0x30, 0, 0, 0x00000017},  // ldb [23]             protocol
+   {0x15, 0, 3, 0x00000011},  // jeq #17              UDP
+   {0x28, 0, 0, 0x00000024},  // ldh [36]             destination port
+   {0x15, 0, 1, UDP_PORT},    // jeq #4449
+   {0x06, 0, 0, 0x00040000},  // ret #262144          accept
+   {0x06, 0, 0, 0x00000000},  // ret #0               drop
+  }
+};
+
+// Ethernet, IPv4 and UDP header for a datagram from and to 127.0.0.1:UDP_PORT, followed by PAYLOAD.
+auto buildFrame(const std::string_view PAYLOAD) -> std::vector<std::uint8_t>
+{
+    const auto             IP_LENGTH  = static_cast<std::uint16_t>(20 + 8 + PAYLOAD.size());
+    const auto             UDP_LENGTH = static_cast<std::uint16_t>(8 + PAYLOAD.size());
+
+    std::vector<std::uint8_t> frame {
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x08, 0x00,                                     // Ethernet
+      0x45, 0, static_cast<std::uint8_t>(IP_LENGTH >> 8U), static_cast<std::uint8_t>(IP_LENGTH & 0xFFU),
+      0, 0, 0x40, 0, 64, 17, 0, 0, 127, 0, 0, 1, 127, 0, 0, 1,                              // IPv4
+      static_cast<std::uint8_t>(UDP_PORT >> 8U), static_cast<std::uint8_t>(UDP_PORT & 0xFFU),
+      static_cast<std::uint8_t>(UDP_PORT >> 8U), static_cast<std::uint8_t>(UDP_PORT & 0xFFU),
+      static_cast<std::uint8_t>(UDP_LENGTH >> 8U), static_cast<std::uint8_t>(UDP_LENGTH & 0xFFU), 0, 0, // UDP
+    };
+
+    std::uint32_t checksum {};
+    for (std::size_t i = 14; i < 34; i += 2)
+    {
+        checksum += static_cast<std::uint32_t>(frame[i] << 8U) | frame[i + 1];
+    }
+    checksum = (checksum & 0xFFFFU) + (checksum >> 16U);
+    checksum = ~checksum & 0xFFFFU;
+    frame[24] = static_cast<std::uint8_t>(checksum >> 8U);
+    frame[25] = static_cast<std::uint8_t>(checksum & 0xFFU);
+
+    frame.insert(frame.end(), PAYLOAD.begin(), PAYLOAD.end());
+    return frame;
+}
+
+auto drain(PacketSocket& capture) -> std::size_t
+{
+    std::size_t captured {};
+    std::size_t bytes {};
+    while (true)
+    {
+        const std::size_t FRAMES = capture.receive(
+          [&bytes](const PacketFrame& frame) { bytes += frame.data().size(); }, std::chrono::milliseconds {100}
+        );
+        if (FRAMES == 0)
+        {
+            break;
+        }
+        captured += FRAMES;
+    }
+    std::cout << "  captured " << captured << " frames, " << bytes << " bytes\n";
+    return captured;
+}
+
+} // namespace
+
+auto main() -> int
+{
+    PacketSocket::RingConfig config {};
+    config.blockSize    = static_cast<std::uint32_t>(1) << 20;
+    config.blockCount   = 8;
+    config.txFrameCount = 256;
+
+    PacketSocket capture("lo", config);
+    capture.attachFilter(FILTER);
+
+    // On loopback every datagram shows up twice, once outgoing and once incoming.
+    std::cout << "UDP socket:\n";
+    const int   UDP_FD = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in destination {};
+    destination.sin_family      = AF_INET;
+    destination.sin_port        = htons(UDP_PORT);
+    destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (std::size_t i = 0; i < DATAGRAMS; ++i)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) // Marginally better than C.
+        ::sendto(UDP_FD, "ping", 4, 0, reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+    }
+    ::close(UDP_FD);
+    drain(capture);
+
+    std::cout << "TX ring:\n";
+    const auto  FRAME = buildFrame("injected");
+    std::size_t injected {};
+    for (std::size_t i = 0; i < DATAGRAMS; ++i)
+    {
+        if (!capture.queueTransmit(FRAME))
+        {
+            capture.flushTransmit();
+            if (!capture.queueTransmit(FRAME))
+            {
+                break;
+            }
+        }
+        ++injected;
+    }
+    capture.flushTransmit();
+    std::cout << "  injected " << injected << " frames\n";
+    drain(capture);
+
+    const auto STATS = capture.getStatistics();
+    std::cout << "kernel: " << STATS.packets << " packets, " << STATS.drops << " drops, " << STATS.queueFreezes
+              << " queue freezes\n";
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include <iostream>
+#include <string>
+
+#include "../Resolver.h"
+
+// Same as client.cpp, but connects by host name through the resolver. Run server.cpp first.
+auto main(int argc, char** argv) -> int
+{
+    const std::string      HOST = argc > 1 ? argv[1] : "localhost"; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const CPPSockets::Port PORT {4444};
+    CPPSockets::Resolver   resolver;
+
+    for (const auto& resolved : resolver.resolve(HOST, CPPSockets::Socket::EAddressFamily::IPV4).get().addresses)
+    {
+        std::cout << HOST << " -> " << static_cast<std::string>(resolved.address) << '\n';
+    }
+
+    try
+    {
+        // Answered from the cache now, only the connect itself still runs on a resolver thread.
+        auto server = resolver.connect(HOST, PORT, true, CPPSockets::Socket::EAddressFamily::IPV4).get();
+        std::cout << *server.recv() << '\n';
+        server.send("hello from client!");
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    const auto STATISTICS = resolver.getStatistics();
+    std::cout << "cache hits: " << STATISTICS.cacheHits << ", queries: " << STATISTICS.queries << '\n';
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Moves the same amount of data from a child process to its parent, once over a loopback TCPSocket and once over
+// a SharedMemoryTransport set up on another loopback connection, and prints the throughput of both.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../ListeningSocket.h"
+#include "../SharedMemoryTransport.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+constexpr std::size_t MESSAGE_SIZE {static_cast<std::size_t>(64 * 1'024)};
+constexpr std::size_t TOTAL_BYTES {static_cast<std::size_t>(4) * 1'024 * 1'024 * 1'024};
+
+template <typename Connection>
+void produce(Connection& connection)
+{
+    const std::string MESSAGE(MESSAGE_SIZE, 'x');
+    for (std::size_t sent = 0; sent < TOTAL_BYTES; sent += MESSAGE_SIZE)
+    {
+        connection.send(MESSAGE);
+    }
+}
+
+template <typename Connection>
+void consume(Connection& connection, const std::string& name)
+{
+    std::vector<char> buffer(MESSAGE_SIZE);
+    std::size_t       received {};
+    const auto        START = std::chrono::steady_clock::now();
+    while (received < TOTAL_BYTES)
+    {
+        const std::int64_t BYTES_READ = connection.recvInto(buffer);
+        if (BYTES_READ <= 0)
+        {
+            std::cerr << name << ": connection lost\n";
+            return;
+        }
+        received += static_cast<std::size_t>(BYTES_READ);
+    }
+    const std::chrono::duration<double> ELAPSED = std::chrono::steady_clock::now() - START;
+    std::cout << name << ": " << static_cast<double>(received) / ELAPSED.count() / 1e9 << " GB/s\n";
+}
+
+} // namespace
+
+auto main() -> int
+{
+    const Port      PORT {4'448};
+    ListeningSocket listener(NetAddress("127.0.0.1"), PORT, true);
+
+    const pid_t     CHILD = ::fork();
+    if (CHILD == 0)
+    {
+        listener.close();
+        {
+            TCPSocket tcp(NetAddress("127.0.0.1"), PORT, true);
+            produce(tcp);
+        }
+        {
+            auto shm = SharedMemoryTransport::connect(TCPSocket(NetAddress("127.0.0.1"), PORT, true));
+            produce(shm);
+        }
+        return 0;
+    }
+
+    {
+        auto tcp = *listener.accept();
+        consume(tcp, "tcp loopback ");
+    }
+    {
+        auto shm = SharedMemoryTransport::accept(*listener.accept());
+        consume(shm, "shared memory");
+    }
+
+    ::waitpid(CHILD, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Runs HTTPSession over SimulatedNetwork instead of loopback. With 100k connections and no kernel involved, the wall
+// clock time per request is the library's own cost (parsing, dispatch, serialization and buffering), while the
+// simulated time shows what the configured link would do to latency. A second run adds loss and reordering.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../HTTP.h"
+#include "../SimulatedNetwork.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Example code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+constexpr std::size_t   CONNECTIONS {100'000};
+constexpr std::size_t   ROUNDS {5};
+constexpr std::uint16_t HTTP_PORT {80};
+
+void run(const std::string& name, const SimulatedNetwork::LinkConfig& config)
+{
+    SimulatedNetwork                 network(config);
+    SimulatedListener                listener = network.listen(Port {HTTP_PORT});
+
+    std::vector<SimulatedConnection> clients {};
+    std::vector<SimulatedConnection> servers {};
+    std::vector<HTTPSession>         sessions {};
+    clients.reserve(CONNECTIONS);
+    servers.reserve(CONNECTIONS);
+    sessions.reserve(CONNECTIONS);
+
+    for (std::size_t i = 0; i < CONNECTIONS; ++i)
+    {
+        clients.push_back(network.connect(Port {HTTP_PORT}));
+    }
+    network.runUntilIdle();
+    while (auto connection = listener.accept())
+    {
+        servers.push_back(std::move(*connection));
+        // Small buffers, the requests are tiny and 100k default sized sessions would need 6 GiB.
+        sessions.emplace_back(1'024);
+    }
+
+    const std::string          REQUEST {"GET /hello HTTP/1.1\r\nHost: simulated\r\n\r\n"};
+    std::array<char, 1'024>    buffer {};
+    std::uint64_t              responses {0};
+    std::chrono::nanoseconds   libraryTime {0};
+    const auto                 SIMULATED_START = network.now();
+
+    for (std::size_t round = 0; round < ROUNDS; ++round)
+    {
+        for (auto& client : clients)
+        {
+            client.send(REQUEST);
+        }
+        network.runUntilIdle();
+
+        // Only the server side is timed, the network itself is not what is being measured.
+        const auto START = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < servers.size(); ++i)
+        {
+            sessions[i].process(
+              servers[i], [](const HTTPRequest&, HTTPResponse& response) { response.setBody(std::string_view {"hello"}); }
+            );
+        }
+        libraryTime += std::chrono::steady_clock::now() - START;
+        network.runUntilIdle();
+
+        for (auto& client : clients)
+        {
+            if (client.recvInto(buffer) > 0)
+            {
+                responses++;
+            }
+        }
+    }
+
+    const auto STATISTICS = network.getStatistics();
+    std::cout << name << ": " << responses << " responses, "
+              << static_cast<double>(libraryTime.count()) / static_cast<double>(responses) << " ns per request in HTTPSession, "
+              << std::chrono::duration<double, std::micro>(network.now() - SIMULATED_START).count() / ROUNDS
+              << " us simulated per round, " << STATISTICS.retransmissions << " retransmissions, " << STATISTICS.reordered
+              << " reordered\n";
+}
+
+} // namespace
+
+auto main() -> int
+{
+    run("clean link", SimulatedNetwork::LinkConfig {});
+    run("lossy link",
+        SimulatedNetwork::LinkConfig {
+          .latency           = std::chrono::microseconds {500},
+          .bandwidth         = 0,
+          .lossRate          = 0.01,
+          .retransmitTimeout = std::chrono::milliseconds {200},
+          .reorderRate       = 0.05,
+          .reorderDelay      = std::chrono::microseconds {100},
+          .maxSegmentSize    = 1'448,
+          .seed              = 42,
+        });
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Tests for ConnectionTable, run the binary, a failed check aborts with the failing line.
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "../ConnectionTable.h"
+#include "../ListeningSocket.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Test code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+int failures {0};
+
+void check(const bool CONDITION, const char* expression, const int LINE)
+{
+    if (!CONDITION)
+    {
+        std::cerr << "line " << LINE << ": check failed: " << expression << '\n';
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__) // NOLINT(cppcoreguidelines-macro-usage)
+
+// Connected loopback sockets, the accepted ends are kept so the peers stay open.
+class Connections
+{
+  private:
+    ListeningSocket        m_listener {NetAddress("127.0.0.1"), Port(0), true};
+    std::vector<TCPSocket> m_accepted;
+
+  public:
+    auto make() -> TCPSocket
+    {
+        TCPSocket client(NetAddress("127.0.0.1"), m_listener.getPort(), true);
+        m_accepted.push_back(std::move(*m_listener.accept()));
+        return client;
+    }
+};
+
+void testStaleHandles()
+{
+    Connections            connections {};
+    ConnectionTable<int>   table {};
+    const ConnectionHandle FIRST = table.insert(connections.make(), 1);
+    CHECK(table.contains(FIRST));
+    CHECK(*table.getUserData(FIRST) == 1);
+
+    CHECK(table.remove(FIRST));
+    CHECK(!table.contains(FIRST));
+    CHECK(table.getSocket(FIRST) == nullptr);
+    CHECK(table.getUserData(FIRST) == nullptr);
+    CHECK(!table.remove(FIRST));
+    CHECK(!table.refresh(FIRST));
+
+    // The freed slot is reused with a new generation, the old handle must not alias the new connection.
+    const ConnectionHandle SECOND = table.insert(connections.make(), 2);
+    CHECK(SECOND.index == FIRST.index);
+    CHECK(SECOND.generation != FIRST.generation);
+    CHECK(!table.contains(FIRST));
+    CHECK(*table.getUserData(SECOND) == 2);
+    CHECK(!table.contains(ConnectionHandle {}));
+}
+
+void testSwapRemove()
+{
+    Connections                   connections {};
+    ConnectionTable<int>          table {};
+    std::vector<ConnectionHandle> handles {};
+    for (int i = 0; i < 4; ++i)
+    {
+        handles.push_back(table.insert(connections.make(), i));
+    }
+
+    // Removing from the front swaps the last entry into the gap, its handle has to follow it.
+    CHECK(table.remove(handles[0]));
+    CHECK(table.size() == 3);
+    for (int i = 1; i < 4; ++i)
+    {
+        CHECK(*table.getUserData(handles[static_cast<std::size_t>(i)]) == i);
+        CHECK(table.getSocket(handles[static_cast<std::size_t>(i)])->getFD() != -1);
+    }
+    CHECK(table.getHandle(0) == handles[3]);
+
+    // Freed slots are reused most recently freed first.
+    CHECK(table.remove(handles[2]));
+    const ConnectionHandle REUSED_LAST  = table.insert(connections.make(), 5);
+    const ConnectionHandle REUSED_FIRST = table.insert(connections.make(), 6);
+    CHECK(REUSED_LAST.index == handles[2].index);
+    CHECK(REUSED_FIRST.index == handles[0].index);
+    CHECK(*table.getUserData(handles[1]) == 1);
+    CHECK(*table.getUserData(handles[3]) == 3);
+    CHECK(*table.getUserData(REUSED_LAST) == 5);
+    CHECK(*table.getUserData(REUSED_FIRST) == 6);
+    CHECK(table.size() == 4);
+}
+
+void testEraseClosedSeesDirectClose()
+{
+    Connections            connections {};
+    ConnectionTable<>      table {};
+    const ConnectionHandle OPEN   = table.insert(connections.make());
+    const ConnectionHandle CLOSED = table.insert(connections.make());
+
+    // Closed behind the table's back, the hot data still holds the old fd.
+    table.getSocket(CLOSED)->close();
+    CHECK(table.eraseClosed() == 1);
+    CHECK(!table.contains(CLOSED));
+    CHECK(table.contains(OPEN));
+    CHECK(table.hot()[0].fd == table.getSocket(OPEN)->getFD());
+
+    table.sockets()[0].close();
+    CHECK(table.refresh(OPEN));
+    CHECK(table.hot()[0].fd == -1);
+    CHECK(table.eraseClosed() == 1);
+    CHECK(table.empty());
+}
+
+} // namespace
+
+auto main() -> int
+{
+    testStaleHandles();
+    testSwapRemove();
+    testEraseClosedSeesDirectClose();
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Tests for HTTPRequestParser, run the binary, a failed check aborts with the failing line.
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <string>
+
+#include "../HTTP.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Test code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+int failures {0};
+
+void check(const bool CONDITION, const char* expression, const int LINE)
+{
+    if (!CONDITION)
+    {
+        std::cerr << "line " << LINE << ": check failed: " << expression << '\n';
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__) // NOLINT(cppcoreguidelines-macro-usage)
+
+auto parse(std::string data, HTTPRequestParser parser = HTTPRequestParser {}) -> HTTPRequestParser::EResult
+{
+    HTTPRequest request {};
+    std::size_t consumed {};
+    return parser.parse(std::span<char> {data}, request, consumed);
+}
+
+const std::string CHUNKED_HEAD {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"};
+
+void testChunkedBody()
+{
+    std::string       data = CHUNKED_HEAD + "3\r\nabc\r\n2;ext=1\r\nde\r\n0\r\n\r\nGET";
+    HTTPRequestParser parser {};
+    HTTPRequest       request {};
+    std::size_t       consumed {};
+    CHECK(parser.parse(std::span<char> {data}, request, consumed) == HTTPRequestParser::EResult::COMPLETE);
+    CHECK(request.getBody() == "abcde");
+    CHECK(consumed == data.size() - 3);
+}
+
+void testIncompleteChunk()
+{
+    CHECK(parse(CHUNKED_HEAD + "5\r\nabc") == HTTPRequestParser::EResult::INCOMPLETE);
+    CHECK(parse(CHUNKED_HEAD + "5\r\nabcde") == HTTPRequestParser::EResult::INCOMPLETE);
+    CHECK(parse(CHUNKED_HEAD + "5\r\nabcde\r") == HTTPRequestParser::EResult::INCOMPLETE);
+}
+
+void testMalformedChunkSize()
+{
+    CHECK(parse(CHUNKED_HEAD + "xyz\r\nabc\r\n") == HTTPRequestParser::EResult::ERROR);
+    CHECK(parse(CHUNKED_HEAD + "\r\nabc\r\n") == HTTPRequestParser::EResult::ERROR);
+    CHECK(parse(CHUNKED_HEAD + "3 \r\nabc\r\n") == HTTPRequestParser::EResult::ERROR);
+    // Does not fit into std::size_t at all.
+    CHECK(parse(CHUNKED_HEAD + "10000000000000000000\r\nabc\r\n") == HTTPRequestParser::EResult::ERROR);
+    // Chunk data not followed by CRLF.
+    CHECK(parse(CHUNKED_HEAD + "3\r\nabcX\r\n") == HTTPRequestParser::EResult::ERROR);
+}
+
+void testOversizedChunkSize()
+{
+    // Sizes close to SIZE_MAX used to wrap around in the length check.
+    CHECK(parse(CHUNKED_HEAD + "fffffffffffffffe\r\nabc") == HTTPRequestParser::EResult::INCOMPLETE);
+    CHECK(parse(CHUNKED_HEAD + "ffffffffffffffff\r\nabc\r\n") == HTTPRequestParser::EResult::INCOMPLETE);
+
+    const HTTPRequestParser LIMITED {HTTPRequestParser::DEFAULT_MAX_HEADERS, 16};
+    CHECK(parse(CHUNKED_HEAD + "fffffffffffffffe\r\nabc", LIMITED) == HTTPRequestParser::EResult::TOO_LARGE);
+    CHECK(parse(CHUNKED_HEAD + "11\r\nabc", LIMITED) == HTTPRequestParser::EResult::TOO_LARGE);
+    // The limit applies to the whole body, not to each chunk.
+    CHECK(parse(CHUNKED_HEAD + "a\r\n0123456789\r\na\r\n0123456789\r\n0\r\n\r\n", LIMITED)
+          == HTTPRequestParser::EResult::TOO_LARGE);
+    CHECK(parse(CHUNKED_HEAD + "10\r\n0123456789abcdef\r\n0\r\n\r\n", LIMITED) == HTTPRequestParser::EResult::COMPLETE);
+}
+
+void testContentLength()
+{
+    CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc") == HTTPRequestParser::EResult::COMPLETE);
+    CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\nab") == HTTPRequestParser::EResult::INCOMPLETE);
+    CHECK(parse("POST / HTTP/1.1\r\nContent-Length: -3\r\n\r\n") == HTTPRequestParser::EResult::ERROR);
+
+    const HTTPRequestParser LIMITED {HTTPRequestParser::DEFAULT_MAX_HEADERS, 16};
+    CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n", LIMITED) == HTTPRequestParser::EResult::TOO_LARGE);
+}
+
+void testTransferEncoding()
+{
+    CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: Chunked\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::COMPLETE);
+    // Only a sole chunked coding is supported, anything stacked on it would have to be decoded.
+    CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::NOT_IMPLEMENTED);
+    CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::NOT_IMPLEMENTED);
+    CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::NOT_IMPLEMENTED);
+    // Content-Length together with Transfer-Encoding, in either order, is a smuggling attempt.
+    CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::ERROR);
+    CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n0\r\n\r\n")
+          == HTTPRequestParser::EResult::ERROR);
+}
+
+void testHeaderFieldName()
+{
+    CHECK(parse("GET / HTTP/1.1\r\nHost: x\r\n\r\n") == HTTPRequestParser::EResult::COMPLETE);
+    CHECK(parse("GET / HTTP/1.1\r\nHost : x\r\n\r\n") == HTTPRequestParser::EResult::ERROR);
+    CHECK(parse("GET / HTTP/1.1\r\nHost\t: x\r\n\r\n") == HTTPRequestParser::EResult::ERROR);
+    CHECK(parse("GET / HTTP/1.1\r\n Host: x\r\n\r\n") == HTTPRequestParser::EResult::ERROR);
+}
+
+void testResponseHead()
+{
+    HTTPResponse response {};
+    std::string  head {};
+    response.setBody(std::string_view {"abc"});
+    response.serializeHead(head);
+    CHECK(head == "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\n");
+
+    response.setRequestMinorVersion(0);
+    response.serializeHead(head);
+    CHECK(head == "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: keep-alive\r\n\r\n");
+
+    response.setKeepAlive(false);
+    response.serializeHead(head);
+    CHECK(head == "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: close\r\n\r\n");
+
+    for (const int STATUS : {204, 304})
+    {
+        response.reset();
+        response.setStatus(STATUS);
+        response.setBody(std::string_view {"abc"});
+        response.serializeHead(head);
+        CHECK(head.find("Content-Length") == std::string::npos);
+        CHECK(response.getWireBody().empty());
+    }
+}
+
+} // namespace
+
+auto main() -> int
+{
+    testChunkedBody();
+    testIncompleteChunk();
+    testMalformedChunkSize();
+    testOversizedChunkSize();
+    testContentLength();
+    testTransferEncoding();
+    testHeaderFieldName();
+    testResponseHead();
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "all checks passed\n";
+    return 0;
+}
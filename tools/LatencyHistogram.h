@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <ostream>
+#include <vector>
+
+namespace CPPSockets
+{
+
+// HDR style histogram: log-linear buckets with a fixed relative precision (1 / 2^(SUB_BUCKET_BITS - 1), about
+// 0.1 % with the default) over the whole range, so recording is a few shifts and one increment.
+// Values are unitless, the load generator records nanoseconds. Values above the maximum are clamped.
+class LatencyHistogram
+{
+  public:
+    static constexpr unsigned      SUB_BUCKET_BITS {11};
+    static constexpr std::uint64_t SUB_BUCKET_COUNT {std::uint64_t {1} << SUB_BUCKET_BITS};
+    static constexpr std::uint64_t SUB_BUCKET_HALF {SUB_BUCKET_COUNT / 2};
+    // 2^40 ns is more than 18 minutes.
+    static constexpr unsigned      MAX_VALUE_BITS {40};
+    static constexpr std::uint64_t MAX_VALUE {(std::uint64_t {1} << MAX_VALUE_BITS) - 1};
+
+  private:
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t              m_totalCount {0};
+    std::uint64_t              m_min {MAX_VALUE};
+    std::uint64_t              m_max {0};
+    double                     m_sum {0.0};
+    double                     m_sumOfSquares {0.0};
+
+    static auto indexOf(const std::uint64_t VALUE) noexcept -> std::size_t
+    {
+        const auto BUCKET = static_cast<unsigned>(
+          std::max(0, static_cast<int>(std::bit_width(VALUE)) - static_cast<int>(SUB_BUCKET_BITS))
+        );
+        return static_cast<std::size_t>((BUCKET * SUB_BUCKET_HALF) + (VALUE >> BUCKET));
+    }
+
+    static auto valueOf(const std::size_t INDEX) noexcept -> std::uint64_t
+    {
+        const std::uint64_t BUCKET = INDEX < SUB_BUCKET_COUNT ? 0 : (INDEX / SUB_BUCKET_HALF) - 1;
+        return (INDEX - (BUCKET * SUB_BUCKET_HALF)) << BUCKET;
+    }
+
+    // Largest value that lands in the same slot, which is what HDR histograms report for percentiles.
+    static auto highestEquivalentValue(const std::size_t INDEX) noexcept -> std::uint64_t
+    {
+        const std::uint64_t BUCKET = INDEX < SUB_BUCKET_COUNT ? 0 : (INDEX / SUB_BUCKET_HALF) - 1;
+        return valueOf(INDEX) + (std::uint64_t {1} << BUCKET) - 1;
+    }
+
+  public:
+    LatencyHistogram() : m_counts(indexOf(MAX_VALUE) + 1, 0) {}
+
+    void record(std::uint64_t value) noexcept
+    {
+        value = std::min(value, MAX_VALUE);
+        m_counts[indexOf(value)]++;
+        m_totalCount++;
+        m_min           = std::min(m_min, value);
+        m_max           = std::max(m_max, value);
+        m_sum          += static_cast<double>(value);
+        m_sumOfSquares += static_cast<double>(value) * static_cast<double>(value);
+    }
+
+    void merge(const LatencyHistogram& other) noexcept
+    {
+        for (std::size_t i = 0; i < m_counts.size(); ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_totalCount   += other.m_totalCount;
+        m_min           = std::min(m_min, other.m_min);
+        m_max           = std::max(m_max, other.m_max);
+        m_sum          += other.m_sum;
+        m_sumOfSquares += other.m_sumOfSquares;
+    }
+
+    void reset() noexcept { *this = LatencyHistogram {}; }
+
+    // PERCENTILE in [0, 100].
+    [[nodiscard]]
+    auto getValueAtPercentile(const double PERCENTILE) const noexcept -> std::uint64_t
+    {
+        if (m_totalCount == 0)
+        {
+            return 0;
+        }
+        const auto TARGET = std::max<std::uint64_t>(
+          1, static_cast<std::uint64_t>(std::ceil(std::clamp(PERCENTILE, 0.0, 100.0) / 100.0 * static_cast<double>(m_totalCount)))
+        );
+        std::uint64_t seen {0};
+        for (std::size_t i = 0; i < m_counts.size(); ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= TARGET)
+            {
+                return std::min(highestEquivalentValue(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    [[nodiscard]]
+    auto getTotalCount() const noexcept -> std::uint64_t
+    {
+        return m_totalCount;
+    }
+
+    [[nodiscard]]
+    auto getMin() const noexcept -> std::uint64_t
+    {
+        return m_totalCount == 0 ? 0 : m_min;
+    }
+
+    [[nodiscard]]
+    auto getMax() const noexcept -> std::uint64_t
+    {
+        return m_max;
+    }
+
+    [[nodiscard]]
+    auto getMean() const noexcept -> double
+    {
+        return m_totalCount == 0 ? 0.0 : m_sum / static_cast<double>(m_totalCount);
+    }
+
+    [[nodiscard]]
+    auto getStdDeviation() const noexcept -> double
+    {
+        if (m_totalCount == 0)
+        {
+            return 0.0;
+        }
+        const double MEAN = getMean();
+        return std::sqrt(std::max(0.0, (m_sumOfSquares / static_cast<double>(m_totalCount)) - (MEAN * MEAN)));
+    }
+
+    // Writes the percentile distribution in the text format of HdrHistogram's outputPercentileDistribution(), which
+    // the usual HdrHistogram plotters read. Values are divided by UNIT_SCALE, e.g. 1000 to print microseconds.
+    void outputPercentileDistribution(std::ostream& out, const double UNIT_SCALE, const unsigned TICKS_PER_HALF_DISTANCE = 5) const
+    {
+        out << std::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+        double percentile {0.0};
+        while (m_totalCount > 0)
+        {
+            const std::uint64_t VALUE = getValueAtPercentile(percentile);
+            std::uint64_t       count {0};
+            for (std::size_t i = 0; i < m_counts.size() && valueOf(i) <= VALUE; ++i)
+            {
+                count += m_counts[i];
+            }
+            const double FRACTION = static_cast<double>(count) / static_cast<double>(m_totalCount);
+            if (FRACTION >= 1.0)
+            {
+                out << std::format("{:12.3f} {:14.12f} {:10} \n", static_cast<double>(VALUE) / UNIT_SCALE, 1.0, count);
+                break;
+            }
+            out << std::format(
+              "{:12.3f} {:14.12f} {:10} {:14.2f}\n",
+              static_cast<double>(VALUE) / UNIT_SCALE,
+              percentile / 100.0,
+              count,
+              1.0 / (1.0 - (percentile / 100.0))
+            );
+            // Ticks get denser with every halving of the distance to 100 %, like HdrHistogram's percentile iterator.
+            const double HALF_DISTANCE = std::exp2(std::floor(std::log2(100.0 / (100.0 - percentile))) + 1.0);
+            percentile += 100.0 / (TICKS_PER_HALF_DISTANCE * HALF_DISTANCE);
+        }
+
+        out << std::format(
+          "#[Mean    = {:12.3f}, StdDeviation   = {:12.3f}]\n", getMean() / UNIT_SCALE, getStdDeviation() / UNIT_SCALE
+        );
+        out << std::format(
+          "#[Max     = {:12.3f}, Total count    = {:12}]\n", static_cast<double>(getMax()) / UNIT_SCALE, m_totalCount
+        );
+        out << std::format(
+          "#[Buckets = {:12}, SubBuckets     = {:12}]\n", (MAX_VALUE_BITS - SUB_BUCKET_BITS) + 1, SUB_BUCKET_COUNT
+        );
+    }
+};
+
+} // namespace CPPSockets
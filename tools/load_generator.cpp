@@ -0,0 +1,635 @@
+// Open-loop load generator for servers built on this library.
+//
+// Requests are sent on a fixed schedule no matter how fast responses come back, and every latency is measured from
+// the time the request was supposed to be sent. A stalled server therefore shows up in the percentiles instead of
+// silently lowering the request rate (coordinated omission). With --rate 0 it runs closed-loop instead, one request
+// in flight per connection, which measures peak throughput but not latency under load.
+//
+// Modes match the example servers:
+//   echo  examples/echo_server.cpp (port 4450), payload of --size bytes, response is the same bytes
+//   http  examples/http_server.cpp (port 8080), POST /echo with a --size byte body, or GET / for size 0
+//   chat  examples/chat_server.cpp (port 4444), message with a unique token, done when the broadcast comes back
+//
+// Example: load_generator --mode echo --port 4450 --connections 1000 --threads 4 --rate 100000 --duration 30
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <poll.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/prctl.h>
+#include <thread>
+#include <vector>
+
+#include "../HTTP.h"
+#include "../Resolver.h"
+#include "../TCPSocket.h"
+#include "LatencyHistogram.h"
+
+// NOLINTNEXTLINE(google-build-using-namespace) // Tool code only.
+using namespace CPPSockets;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Workers sleep in ppoll() until this long before the next send is due and spin from there, sleeping any closer
+// would make sends late by the scheduler's wakeup latency.
+constexpr std::chrono::microseconds SPIN_WINDOW {50};
+constexpr std::chrono::milliseconds MAX_POLL_TIMEOUT {100};
+
+enum class EMode : std::uint8_t
+{
+    ECHO,
+    HTTP,
+    CHAT
+};
+
+struct Options
+{
+    std::string          host {"127.0.0.1"};
+    std::uint16_t        port {4'450};
+    EMode                mode {EMode::ECHO};
+    std::size_t          connections {16};
+    std::size_t          threads {1};
+    // Requests per second over all connections, 0 for closed-loop.
+    double               rate {1'000.0};
+    std::chrono::seconds duration {10};
+    std::chrono::seconds warmup {0};
+    std::size_t          size {64};
+    // Requests per connection before it is closed and opened again, 0 to keep connections open.
+    std::uint64_t        churn {0};
+    std::string          histogramFile {};
+};
+
+struct Results
+{
+    LatencyHistogram latency {};
+    LatencyHistogram connectLatency {};
+    // How long after their intended time requests actually went out. Part of the request latency, so a large value
+    // means the generator and not the server is the bottleneck.
+    LatencyHistogram sendLag {};
+    std::uint64_t    sent {0};
+    std::uint64_t    completed {0};
+    std::uint64_t    connects {0};
+    std::uint64_t    connectErrors {0};
+    std::uint64_t    disconnects {0};
+    // Requests still waiting for a response when the server closed the connection.
+    std::uint64_t    failed {0};
+};
+
+struct Connection
+{
+    std::uint64_t                 id {0};
+    std::optional<TCPSocket>      socket {};
+    // Intended send times of the requests still waiting for a response, oldest first.
+    std::deque<Clock::time_point> outstanding {};
+    std::string                   received {};
+    Clock::time_point             nextSend {};
+    Clock::time_point             nextConnect {};
+    std::uint64_t                 sequence {0};
+    std::uint64_t                 sentOnSocket {0};
+    bool                          draining {false};
+};
+
+void printUsage(const char* name)
+{
+    std::cerr << "usage: " << name
+              << " [--host HOST] [--port PORT] [--mode echo|http|chat] [--connections N] [--threads N] [--rate REQ_PER_S]"
+                 " [--duration S] [--warmup S] [--size BYTES] [--churn REQUESTS] [--histogram FILE]\n";
+}
+
+auto parseOptions(const std::span<char*> args) -> std::optional<Options>
+{
+    Options options {};
+    for (std::size_t i = 1; i < args.size(); ++i)
+    {
+        const std::string_view KEY {args[i]};
+        if (KEY == "--help" || i + 1 >= args.size())
+        {
+            return std::nullopt;
+        }
+        const std::string VALUE {args[++i]};
+        try
+        {
+            if (KEY == "--host")
+            {
+                options.host = VALUE;
+            }
+            else if (KEY == "--port")
+            {
+                options.port = static_cast<std::uint16_t>(std::stoul(VALUE));
+            }
+            else if (KEY == "--mode")
+            {
+                if (VALUE == "echo")
+                {
+                    options.mode = EMode::ECHO;
+                }
+                else if (VALUE == "http")
+                {
+                    options.mode = EMode::HTTP;
+                }
+                else if (VALUE == "chat")
+                {
+                    options.mode = EMode::CHAT;
+                }
+                else
+                {
+                    return std::nullopt;
+                }
+            }
+            else if (KEY == "--connections")
+            {
+                options.connections = std::max<std::size_t>(1, std::stoul(VALUE));
+            }
+            else if (KEY == "--threads")
+            {
+                options.threads = std::max<std::size_t>(1, std::stoul(VALUE));
+            }
+            else if (KEY == "--rate")
+            {
+                options.rate = std::max(0.0, std::stod(VALUE));
+            }
+            else if (KEY == "--duration")
+            {
+                options.duration = std::chrono::seconds {std::stoul(VALUE)};
+            }
+            else if (KEY == "--warmup")
+            {
+                options.warmup = std::chrono::seconds {std::stoul(VALUE)};
+            }
+            else if (KEY == "--size")
+            {
+                options.size = std::stoul(VALUE);
+            }
+            else if (KEY == "--churn")
+            {
+                options.churn = std::stoull(VALUE);
+            }
+            else if (KEY == "--histogram")
+            {
+                options.histogramFile = VALUE;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+    }
+    if (options.mode == EMode::ECHO && options.size == 0)
+    {
+        // An empty echo never comes back.
+        return std::nullopt;
+    }
+    options.threads = std::min(options.threads, options.connections);
+    return options;
+}
+
+// Builds the requests and finds the responses for one mode.
+class Protocol
+{
+  private:
+    EMode       m_mode;
+    std::string m_request {};
+    std::size_t m_responseSize {0};
+
+    static auto chatToken(const Connection& connection, const std::uint64_t SEQUENCE) -> std::string
+    {
+        return std::format("#{}:{};", connection.id, SEQUENCE);
+    }
+
+  public:
+    Protocol(const EMode MODE, const std::size_t SIZE) : m_mode {MODE}
+    {
+        const std::string PAYLOAD(SIZE, 'x');
+        if (MODE == EMode::HTTP)
+        {
+            m_request = SIZE == 0 ? std::string {"GET / HTTP/1.1\r\nHost: load\r\n\r\n"}
+                                  : std::format("POST /echo HTTP/1.1\r\nHost: load\r\nContent-Length: {}\r\n\r\n{}", SIZE, PAYLOAD);
+        }
+        else
+        {
+            m_request      = PAYLOAD;
+            m_responseSize = SIZE;
+        }
+    }
+
+    void send(Connection& connection) const
+    {
+        if (m_mode == EMode::CHAT)
+        {
+            connection.socket->send(chatToken(connection, connection.sequence) + m_request + '\n');
+        }
+        else
+        {
+            connection.socket->send(m_request);
+        }
+        connection.sequence++;
+    }
+
+    // Length of the complete response at the front of the received data, 0 if it is still incomplete.
+    [[nodiscard]]
+    auto findResponse(const Connection& connection) const -> std::size_t
+    {
+        const std::string& data = connection.received;
+        switch (m_mode)
+        {
+            case EMode::ECHO:
+                return data.size() >= m_responseSize && m_responseSize > 0 ? m_responseSize : 0;
+            case EMode::HTTP:
+            {
+                const std::size_t HEAD_END = data.find("\r\n\r\n");
+                if (HEAD_END == std::string::npos)
+                {
+                    return 0;
+                }
+                std::size_t       bodySize {0};
+                const std::string_view HEAD {data.data(), HEAD_END};
+                for (std::size_t lineStart = HEAD.find("\r\n"); lineStart != std::string_view::npos;)
+                {
+                    lineStart                  += 2;
+                    const std::size_t LINE_END  = HEAD.find("\r\n", lineStart);
+                    const std::string_view LINE = HEAD.substr(lineStart, LINE_END - lineStart);
+                    const std::size_t COLON     = LINE.find(':');
+                    if (COLON != std::string_view::npos
+                        && HTTPDetail::equalsIgnoreCase(HTTPDetail::trim(LINE.substr(0, COLON)), "Content-Length"))
+                    {
+                        const std::string_view VALUE = HTTPDetail::trim(LINE.substr(COLON + 1));
+                        std::from_chars(VALUE.data(), VALUE.data() + VALUE.size(), bodySize);
+                    }
+                    lineStart = LINE_END;
+                }
+                const std::size_t TOTAL = HEAD_END + 4 + bodySize;
+                return data.size() >= TOTAL ? TOTAL : 0;
+            }
+            case EMode::CHAT:
+            {
+                // Everything before the token are other clients' messages, they are consumed along with it.
+                const std::uint64_t SEQUENCE = connection.sequence - connection.outstanding.size();
+                const std::string   TOKEN    = chatToken(connection, SEQUENCE);
+                const std::size_t   POSITION = data.find(TOKEN);
+                return POSITION == std::string::npos ? 0 : POSITION + TOKEN.size();
+            }
+        }
+        return 0;
+    }
+};
+
+class Worker
+{
+  private:
+    const Options&          m_options;
+    const ResolvedAddress&  m_address;
+    const Protocol&         m_protocol;
+    std::vector<Connection> m_connections {};
+    std::vector<pollfd>     m_pollFds {};
+    std::vector<std::size_t> m_pollIndices {};
+    std::array<char, 64 * 1'024> m_buffer {};
+    Clock::time_point       m_warmupEnd {};
+    // Time between two requests of the same connection, zero for closed-loop.
+    Clock::duration         m_interval {};
+    Results                 m_results {};
+
+    [[nodiscard]]
+    auto isMeasured(const Clock::time_point TIME_POINT) const noexcept -> bool
+    {
+        return TIME_POINT >= m_warmupEnd;
+    }
+
+    void connect(Connection& connection, const Clock::time_point NOW)
+    {
+        try
+        {
+            connection.socket.emplace(m_address.address, Port {m_options.port}, false, m_address.family);
+            connection.socket->enableCoalescing();
+            const auto CONNECTED = Clock::now();
+            if (isMeasured(NOW))
+            {
+                m_results.connectLatency.record(static_cast<std::uint64_t>((CONNECTED - NOW).count()));
+            }
+            m_results.connects++;
+            connection.received.clear();
+            connection.sentOnSocket = 0;
+            connection.draining     = false;
+        }
+        catch (const std::exception&)
+        {
+            connection.socket.reset();
+            connection.nextConnect = NOW + std::chrono::milliseconds {100};
+            m_results.connectErrors++;
+        }
+    }
+
+    void disconnect(Connection& connection)
+    {
+        connection.socket.reset();
+        connection.outstanding.clear();
+        connection.received.clear();
+    }
+
+    void sendDue(Connection& connection, const Clock::time_point NOW)
+    {
+        const auto SEND_ONE = [&](const Clock::time_point INTENDED)
+        {
+            m_protocol.send(connection);
+            if (m_interval != Clock::duration::zero() && isMeasured(INTENDED))
+            {
+                m_results.sendLag.record(static_cast<std::uint64_t>((Clock::now() - INTENDED).count()));
+            }
+            connection.outstanding.push_back(INTENDED);
+            connection.sentOnSocket++;
+            m_results.sent++;
+            if (m_options.churn > 0 && connection.sentOnSocket >= m_options.churn)
+            {
+                connection.draining = true;
+            }
+        };
+
+        if (m_interval == Clock::duration::zero())
+        {
+            if (connection.outstanding.empty() && !connection.draining)
+            {
+                SEND_ONE(NOW);
+            }
+        }
+        else
+        {
+            // Requests missed while reconnecting or draining are sent late but keep their intended time.
+            while (connection.nextSend <= NOW && !connection.draining)
+            {
+                SEND_ONE(connection.nextSend);
+                connection.nextSend += m_interval;
+            }
+        }
+        connection.socket->flush();
+    }
+
+    void receive(Connection& connection)
+    {
+        while (connection.socket->isOpen())
+        {
+            const std::int64_t BYTES_READ = connection.socket->recvInto(m_buffer);
+            if (BYTES_READ <= 0)
+            {
+                break;
+            }
+            connection.received.append(m_buffer.data(), static_cast<std::size_t>(BYTES_READ));
+        }
+
+        const auto NOW = Clock::now();
+        while (!connection.outstanding.empty())
+        {
+            const std::size_t LENGTH = m_protocol.findResponse(connection);
+            if (LENGTH == 0)
+            {
+                break;
+            }
+            const auto INTENDED = connection.outstanding.front();
+            connection.outstanding.pop_front();
+            connection.received.erase(0, LENGTH);
+            m_results.completed++;
+            if (isMeasured(INTENDED))
+            {
+                m_results.latency.record(static_cast<std::uint64_t>((NOW - INTENDED).count()));
+            }
+        }
+
+        if (!connection.socket->isOpen())
+        {
+            m_results.disconnects++;
+            m_results.failed += connection.outstanding.size();
+            disconnect(connection);
+        }
+    }
+
+  public:
+    Worker(
+      const Options&         options,
+      const ResolvedAddress& address,
+      const Protocol&        protocol,
+      const std::size_t      FIRST_ID,
+      const std::size_t      COUNT,
+      const Clock::time_point START
+    )
+      : m_options {options}, m_address {address}, m_protocol {protocol}, m_warmupEnd {START + options.warmup}
+    {
+        if (options.rate > 0.0)
+        {
+            m_interval = std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double> {static_cast<double>(options.connections) / options.rate}
+            );
+        }
+        m_connections.resize(COUNT);
+        for (std::size_t i = 0; i < COUNT; ++i)
+        {
+            m_connections[i].id = FIRST_ID + i;
+            // Spread the first requests over one interval, all connections firing at once would be a burst.
+            m_connections[i].nextSend =
+              START + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double> {static_cast<double>(FIRST_ID + i) / std::max(options.rate, 1.0)}
+                      );
+        }
+    }
+
+    void run(const Clock::time_point END)
+    {
+        // The default timer slack of 50 us would let ppoll() oversleep the spin window.
+        prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+        while (true)
+        {
+            auto NOW = Clock::now();
+            if (NOW >= END)
+            {
+                break;
+            }
+
+            m_pollFds.clear();
+            m_pollIndices.clear();
+            Clock::time_point wakeUp = END;
+            for (std::size_t i = 0; i < m_connections.size(); ++i)
+            {
+                Connection& connection = m_connections[i];
+                if (connection.socket.has_value() && connection.draining && connection.outstanding.empty())
+                {
+                    disconnect(connection);
+                }
+                if (!connection.socket.has_value())
+                {
+                    if (connection.nextConnect > NOW)
+                    {
+                        wakeUp = std::min(wakeUp, connection.nextConnect);
+                        continue;
+                    }
+                    // Connecting blocks. The time it takes shows up in the latency of the requests it delays.
+                    connect(connection, NOW);
+                    NOW = Clock::now();
+                    if (!connection.socket.has_value())
+                    {
+                        continue;
+                    }
+                }
+
+                sendDue(connection, NOW);
+                if (m_interval != Clock::duration::zero() && !connection.draining)
+                {
+                    wakeUp = std::min(wakeUp, connection.nextSend);
+                }
+                const bool WANTS_WRITE = connection.socket->getPendingBytes() > 0;
+                m_pollFds.push_back(pollfd {
+                  .fd      = connection.socket->getFD(),
+                  .events  = static_cast<short>(POLLIN | (WANTS_WRITE ? POLLOUT : 0)),
+                  .revents = 0,
+                });
+                m_pollIndices.push_back(i);
+            }
+
+            // Nanosecond timeout, poll()'s whole milliseconds would make sends up to a millisecond late and that delay
+            // would be counted as server latency.
+            const auto      SLEEP = std::clamp<Clock::duration>(
+              wakeUp - Clock::now() - SPIN_WINDOW, Clock::duration::zero(), MAX_POLL_TIMEOUT
+            );
+            const auto      SECONDS = std::chrono::duration_cast<std::chrono::seconds>(SLEEP);
+            const timespec  TIMEOUT {
+              .tv_sec  = static_cast<time_t>(SECONDS.count()),
+              .tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(SLEEP - SECONDS).count()),
+            };
+            if (::ppoll(m_pollFds.data(), m_pollFds.size(), &TIMEOUT, nullptr) <= 0)
+            {
+                continue;
+            }
+            for (std::size_t i = 0; i < m_pollFds.size(); ++i)
+            {
+                Connection& connection = m_connections[m_pollIndices[i]];
+                if ((m_pollFds[i].revents & POLLOUT) != 0)
+                {
+                    connection.socket->flush();
+                }
+                if ((m_pollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+                {
+                    receive(connection);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto getResults() const noexcept -> const Results&
+    {
+        return m_results;
+    }
+};
+
+void printSummary(const std::string& name, const LatencyHistogram& histogram)
+{
+    constexpr double MICROSECONDS {1'000.0};
+    std::cout << std::format(
+      "{:<8} p50 {:>10.1f} us  p90 {:>10.1f} us  p99 {:>10.1f} us  p99.9 {:>10.1f} us  max {:>10.1f} us\n",
+      name,
+      static_cast<double>(histogram.getValueAtPercentile(50.0)) / MICROSECONDS,
+      static_cast<double>(histogram.getValueAtPercentile(90.0)) / MICROSECONDS,
+      static_cast<double>(histogram.getValueAtPercentile(99.0)) / MICROSECONDS,
+      static_cast<double>(histogram.getValueAtPercentile(99.9)) / MICROSECONDS,
+      static_cast<double>(histogram.getMax()) / MICROSECONDS
+    );
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const auto OPTIONS = parseOptions(std::span<char*> {argv, static_cast<std::size_t>(argc)});
+    if (!OPTIONS.has_value())
+    {
+        printUsage(argv[0]); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return 1;
+    }
+    const Options& options = *OPTIONS;
+
+    Resolver       resolver {};
+    const auto     RESOLVED = resolver.resolve(options.host).get();
+    if (!RESOLVED.isOk())
+    {
+        std::cerr << "Unable to resolve " << options.host << ": " << RESOLVED.getErrorMessage() << '\n';
+        return 1;
+    }
+    const ResolvedAddress& address = RESOLVED.addresses.front();
+    const Protocol         PROTOCOL {options.mode, options.size};
+
+    const auto             START = Clock::now();
+    const auto             END   = START + options.warmup + options.duration;
+    std::vector<Worker>    workers {};
+    workers.reserve(options.threads);
+    for (std::size_t i = 0; i < options.threads; ++i)
+    {
+        const std::size_t FIRST = options.connections * i / options.threads;
+        const std::size_t LAST  = options.connections * (i + 1) / options.threads;
+        workers.emplace_back(options, address, PROTOCOL, FIRST, LAST - FIRST, START);
+    }
+    {
+        std::vector<std::jthread> threads {};
+        for (auto& worker : workers)
+        {
+            threads.emplace_back([&worker, END]() { worker.run(END); });
+        }
+    }
+
+    Results total {};
+    for (const auto& worker : workers)
+    {
+        const Results& results = worker.getResults();
+        total.latency.merge(results.latency);
+        total.connectLatency.merge(results.connectLatency);
+        total.sendLag.merge(results.sendLag);
+        total.sent          += results.sent;
+        total.completed     += results.completed;
+        total.connects      += results.connects;
+        total.connectErrors += results.connectErrors;
+        total.disconnects   += results.disconnects;
+        total.failed        += results.failed;
+    }
+
+    const double SECONDS = std::chrono::duration<double> {options.duration}.count();
+    std::cout << std::format(
+      "{} requests sent, {} completed, {} failed, {:.0f} req/s measured, {} connects, {} connect errors, {} disconnects\n",
+      total.sent,
+      total.completed,
+      total.failed,
+      static_cast<double>(total.latency.getTotalCount()) / SECONDS,
+      total.connects,
+      total.connectErrors,
+      total.disconnects
+    );
+    printSummary("request", total.latency);
+    printSummary("connect", total.connectLatency);
+    if (options.rate > 0.0)
+    {
+        printSummary("send lag", total.sendLag);
+    }
+
+    if (!options.histogramFile.empty())
+    {
+        std::ofstream file {options.histogramFile};
+        total.latency.outputPercentileDistribution(file, 1'000.0);
+    }
+    else
+    {
+        std::cout << '\n';
+        total.latency.outputPercentileDistribution(std::cout, 1'000.0);
+    }
+    return 0;
+}